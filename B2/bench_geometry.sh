@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# 几何布局基准测试：对每种布局/包络体/铜棒模型组合跑同一组 100 GeV pi- 事例，
+# 汇总体素内存、物理体数目、构建时间与 steps/s（只做测量，不附参考数据）
+# 用法：./bench_geometry.sh [可执行文件]
+
+G4_APP=${1:-./B2}
+CONFIGS=(
+  "placement none nested"
+  "placement calorimeter nested"
+  "placement tower nested"
+  "replica none nested"
+  "lattice none nested"
+  "placement none flat"
+  "lattice none flat"
+)
+
+for CONFIG in "${CONFIGS[@]}"
+do
+    set -- ${CONFIG}
+    TAG="$1_$2_$3"
+    echo "===== 布局：$1  包络体：$2  铜棒模型：$3 ====="
+    cat > bench_${TAG}.mac << EOF2
+/B2/det/layout $1
+/B2/det/envelope $2
+/B2/det/rodModel $3
+/control/execute bench.mac
+EOF2
+    ${G4_APP} bench_${TAG}.mac > bench_${TAG}.log 2>&1
+    grep -E "### Rod layout|Total memory consumed|steps/s" bench_${TAG}.log
+done
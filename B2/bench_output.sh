@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# 输出格式基准测试：同一组 100 GeV pi- 事例分别用 root / raw / columnar 输出，
+# 汇总事例循环中的输出耗时、run 结束时的写出耗时、写线程统计与输出文件大小
+# 用法：./bench_output.sh [可执行文件]
+
+G4_APP=${1:-./B2}
+
+declare -A OUTPUT=( [root]=PhotonData_bench.root [raw]=PhotonData_bench.b2raw [columnar]=PhotonData_bench.b2col )
+
+for TYPE in root raw columnar
+do
+    echo "===== 输出格式：${TYPE} ====="
+    cat > bench_output_${TYPE}.mac << EOF2
+/B2/output/fileType ${TYPE}
+/control/execute bench.mac
+EOF2
+    ${G4_APP} bench_output_${TYPE}.mac > bench_output_${TYPE}.log 2>&1
+    grep -E "steps/s| Output:|Async writer|queue depth" bench_output_${TYPE}.log
+    du -sh ${OUTPUT[$TYPE]}
+done
@@ -0,0 +1,77 @@
+/// \file B2/include/AsyncWriter.hh
+/// \brief Definition of the B2::AsyncWriter class
+
+#ifndef B2AsyncWriter_h
+#define B2AsyncWriter_h 1
+#include "globals.hh"
+#include "EventQueue.hh"
+#include "OutputSink.hh"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace B2
+{
+
+/// Asynchronous event output, used instead of G4AnalysisManager ntuple
+/// merging when /B2/output/fileType is not root.
+///
+/// Every worker pushes its event records into its own EventQueue; a writer
+/// thread started by the master at the beginning of the run drains the queues
+/// in batches into an OutputSink, overlapping the I/O with the simulation.
+/// A worker whose queue is full waits for the writer (back-pressure); the
+/// number and duration of these stalls and the queue depth seen by the writer
+/// are printed at the end of the run. The queues live as long as the writer;
+/// Start() resizes them when the requested capacity has changed since the
+/// previous run.
+
+class AsyncWriter
+{
+  public:
+    static AsyncWriter& Instance();
+
+    // 主线程：run 开始时打开输出、把已有队列调整为 capacity 并启动写线程，
+    // run 结束时（工作线程已结束）排空并停止；打不开输出文件是致命错误
+    G4bool Start(std::unique_ptr<OutputSink> sink, const G4String& fileName, G4int nTowers,
+                 std::size_t capacity);
+    void Stop();
+    G4bool IsActive() const { return fActive.load(std::memory_order_acquire); }
+
+    // 工作线程：创建本线程的队列（每线程一次，容量为 Start() 给出的值）
+    EventQueue* AttachProducer();
+
+    // 生产者：取得可写的槽，队列满时等待写线程
+    static EventRecord* Claim(EventQueue* queue);
+
+  private:
+    AsyncWriter() = default;
+    ~AsyncWriter();
+
+    void Run();   // 写线程主循环
+    std::size_t Drain(const std::vector<EventQueue*>& queues);
+
+    std::mutex fMutex;                               // 保护 fQueues
+    std::vector<std::unique_ptr<EventQueue>> fQueues;
+    std::size_t fCapacity = 1024;                    // 每个队列的记录数
+    std::unique_ptr<OutputSink> fSink;
+    std::thread fThread;
+    std::atomic<G4bool> fStop{false};
+    std::atomic<G4bool> fActive{false};  // 输出文件已打开、写线程在运行
+
+    // 写线程统计（Stop() 在 join 之后读取）
+    G4long fRecords = 0;
+    G4long fDepthSamples = 0;
+    G4double fDepthSum = 0.;
+    std::size_t fMaxDepth = 0;
+
+    static constexpr std::size_t kBatch = 64; // 每个队列每轮最多写出的记录数
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,33 @@
+/// \file B2/include/BalancedRunManager.hh
+/// \brief Definition of the B2::BalancedRunManager class
+
+#ifndef B2BalancedRunManager_h
+#define B2BalancedRunManager_h 1
+#include "G4MTRunManager.hh"
+#include "globals.hh"
+
+namespace B2
+{
+
+/// Multi-threaded run manager with adaptive event chunks (main -b adaptive).
+///
+/// G4MTRunManager hands out eventModulo events per worker request; here the
+/// chunk size is recomputed for every request by LoadBalancer from the
+/// energy-dependent cost of the coming events, so the last events of a run
+/// are dealt out one by one instead of in fixed chunks.
+
+class BalancedRunManager : public G4MTRunManager
+{
+  public:
+    BalancedRunManager() = default;
+    ~BalancedRunManager() override = default;
+
+    G4int SetUpNEvents(G4Event* event, G4SeedsQueue* seedsQueue,
+                       G4bool reseedRequired = true) override;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
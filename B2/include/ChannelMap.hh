@@ -0,0 +1,99 @@
+/// \file B2/include/ChannelMap.hh
+/// \brief Definition of the B2::ChannelMap class
+
+#ifndef B2ChannelMap_h
+#define B2ChannelMap_h 1
+#include "globals.hh"
+#include "G4VTouchable.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+enum class FiberType { Scint = 0, Cerenkov = 1 };
+
+/// Geometry constants and touchable depths used by ChannelMap.
+
+struct ChannelGeometry
+{
+  enum class Addressing {
+    Copy,       // 铜棒副本号即铜棒编号（逐根放置 / calorimeter 包络）
+    TowerCopy,  // tower 副本号 + tower 内铜棒副本号（tower 包络）
+    Lattice,    // 64×64 点阵的全局列号/行号
+    Replica     // 嵌套复制体：tower 行/列 + tower 内列/行
+  };
+
+  Addressing addressing = Addressing::Copy;
+  G4int rodPerTower = 0;     // 每个 tower 每边的铜棒数
+  G4int towerPerSide = 0;    // 每边的 tower 数
+  G4int nScintFiber = 0;
+  G4int nCerenkovFiber = 0;
+  G4int rodDepth = 0;        // 铜棒相对光纤的 touchable 深度
+  G4int towerDepth = 0;      // replica：tower 列所在深度（相对光纤）
+};
+
+/// Dense channel addressing of the rod matrix.
+///
+/// The rod ID is towerID*rodsPerTower + i*rodPerTower + j; a fiber channel is
+/// rodID*fibersPerRod + fiber slot (scintillating fibers first, then Cerenkov),
+/// a dense 32-bit index. Build() fills lookup tables from the DetectorConstruction
+/// constants, so that a fiber touchable is turned into a rod or fiber channel
+/// with a couple of copy-number reads and table lookups, and a channel is
+/// decoded into tower/i/j/fiber without divisions. Shared read-only by all
+/// threads (stepping, FiberSD and the ntuple writer).
+
+class ChannelMap
+{
+  public:
+    ChannelMap() = default;
+    ~ChannelMap() = default;
+
+    void Build(const ChannelGeometry& geometry);
+
+    // touchable 深度0为光纤
+    G4int GetRodID(const G4VTouchable* touchable) const;
+    G4int GetChannel(const G4VTouchable* touchable, FiberType type) const {
+      return EncodeChannel(GetRodID(touchable), type, touchable->GetCopyNumber(0));
+    }
+
+    // 编码
+    G4int EncodeRod(G4int tower, G4int i, G4int j) const {
+      return tower*fRodsPerTower + i*fGeometry.rodPerTower + j;
+    }
+    G4int EncodeChannel(G4int rod, FiberType type, G4int fiberCopy) const {
+      return rod*fFibersPerRod + (type == FiberType::Scint ? 0 : fGeometry.nScintFiber) + fiberCopy;
+    }
+
+    // 解码（查表）
+    G4int GetTower(G4int rod) const { return fRodTower[rod]; }
+    G4int GetI(G4int rod) const { return fRodI[rod]; }
+    G4int GetJ(G4int rod) const { return fRodJ[rod]; }
+    G4int GetRodOfChannel(G4int channel) const { return fChannelRod[channel]; }
+    G4int GetFiberSlot(G4int channel) const { return fChannelSlot[channel]; }
+    FiberType GetFiberType(G4int channel) const {
+      return fChannelSlot[channel] < fGeometry.nScintFiber ? FiberType::Scint : FiberType::Cerenkov;
+    }
+
+    G4int GetNumberOfRods() const { return G4int(fRodTower.size()); }
+    G4int GetNumberOfChannels() const { return G4int(fChannelRod.size()); }
+    G4int GetNumberOfTowers() const { return fGeometry.towerPerSide*fGeometry.towerPerSide; }
+    G4int GetRodsPerTower() const { return fRodsPerTower; }
+
+  private:
+    ChannelGeometry fGeometry;
+    G4int fRodsPerTower = 0;
+    G4int fFibersPerRod = 0;
+    G4int fLatticeSide = 0;               // 点阵每边的铜棒数
+
+    std::vector<G4int> fTowerBase;        // tower 副本号/复制号 -> towerID*rodsPerTower
+    std::vector<G4int> fLatticeRod;       // 点阵 (iGlobal, jGlobal) -> 铜棒编号
+    std::vector<G4int> fRodTower, fRodI, fRodJ;   // 铜棒编号 -> tower/i/j
+    std::vector<G4int> fChannelRod, fChannelSlot; // 通道号 -> 铜棒编号/光纤槽位
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -6,35 +6,120 @@
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
 #include "G4NistManager.hh"
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
+#include "ReadoutParameters.hh"
+#include "DigitizerParameters.hh"
+#include "ChannelMap.hh"
+
+#include <memory>
+#include <vector>
+
+class G4UserLimits;
 
 class G4VPhysicalVolume;
 class G4LogicalVolume;
 class G4UniformMagField;
 class G4FieldManager;
 class G4GlobalMagFieldMessenger;
+class G4GenericMessenger;
 
 namespace B2
 {
 
 /// Detector construction class to define materials and geometry.
 /// and global uniform magnetic field.
+///
+/// Two rod layouts can be selected with /B2/det/layout (before /run/initialize):
+/// - placement: 4096 individual rod placements directly in the world (default)
+/// - replica:   World -> Calorimeter -> tower row -> tower -> rod column -> rod cell,
+///              built with nested G4PVReplica; the whole calorimeter is rotated.
+/// - lattice:   World -> Calorimeter -> rod column (x, 64) -> rod cell (y, 64),
+///              a single regular 64x64 replica lattice whose rod index is computed
+///              arithmetically by G4ReplicaNavigation; needs Tower_spacing equal to
+///              RodPerTower*CuRod_spacing, otherwise falls back to replica.
+/// With the placement layout, /B2/det/envelope puts the axis-aligned rod lattice
+/// into a rotated LogicCalorimeter (calorimeter) and optionally into 16 LogicTower
+/// envelopes sharing one 256-rod logical volume (tower); none keeps the legacy tree.
+/// /B2/det/rodModel selects the rod internals: nested (Cu rod -> air hole -> 7 fibers)
+/// or flat (7 fibers plus a hole-minus-fibers boolean air volume directly in the rod).
+/// The lattice is checked analytically by LatticeValidator (cached on disk, see
+/// /B2/det/overlapCache); the full Geant4 overlap check is opt-in via /B2/det/checkOverlaps.
+/// In all layouts the rod ID is towerID*256 + i*16 + j, see ChannelMap.
+///
+/// /B2/det/readout selects where photons are counted: stepping (SteppingAction
+/// on every step, default) or sd (FiberSD attached to the two fiber volumes in
+/// ConstructSDandField(), no stepping action unless steps are counted).
+/// Every logical volume shares one G4UserLimits whose maximum time is the
+/// killLate cut of the run (applied by G4UserSpecialCuts, see main.cc).
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
   public:
-    DetectorConstruction() = default;
-    ~DetectorConstruction() override = default;
+    enum class Layout { Placement, Replica, Lattice };
+    enum class Envelope { None, Calorimeter, Tower };
+    enum class RodModel { Nested, Flat };
+    enum class Readout { Stepping, SD };
+
+    DetectorConstruction();
+    ~DetectorConstruction() override;
 
     G4VPhysicalVolume* Construct() override;
-    void ConstructSDandField() override {};
+    void ConstructSDandField() override;
 
     G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
     G4LogicalVolume* GetScoringVolumeCerenkov() const { return fScoringVolumeCerenkov; }
 
+    void SetLayout(G4String name);
+    Layout GetLayout() const { return fLayout; }
+    void SetEnvelope(G4String name);
+    Envelope GetEnvelope() const { return fEnvelope; }
+    void SetRodModel(G4String name);
+    RodModel GetRodModel() const { return fRodModel; }
+
+    void SetReadout(G4String name);
+    Readout GetReadout() const { return fReadout; }
+
+    // 读出参数（/B2/readout/），所有线程共用
+    const ReadoutParameters& GetReadoutParameters() const { return fReadoutParameters; }
+    // killLate 的时间上限（各逻辑体共用的 G4UserLimits），主线程在 run 开始时调用
+    void UpdateTimeLimit() const;
+    // 数字化参数（/B2/digi/），所有线程共用
+    const DigitizerParameters& GetDigitizerParameters() const { return fDigitizerParameters; }
+
+    // 读出通道数（铜棒数）
+    G4int GetNumberOfRods() const;
+    G4int GetNumberOfTowers() const;
+    G4double GetFiberLength() const;
+
+    // 通道编号表，在 Construct() 中建立
+    const ChannelMap& GetChannelMap() const { return fChannelMap; }
+
   private:
-    G4LogicalVolume* CreateSingleCuRodLogical(G4NistManager* nist); // 声明封装函数 
+    G4LogicalVolume* CreateSingleCuRodLogical(G4NistManager* nist); // 声明封装函数
+    void PlaceRodsInWorld(G4LogicalVolume* logicWorld, G4LogicalVolume* logicRod,
+                          G4RotationMatrix* rot);
+    G4LogicalVolume* BuildEnvelopeCalorimeter(G4LogicalVolume* logicRod, G4Material* air);
+    G4LogicalVolume* BuildReplicaCalorimeter(G4LogicalVolume* logicRod, G4Material* air);
+    G4LogicalVolume* BuildLatticeCalorimeter(G4LogicalVolume* logicRod, G4Material* air);
+    void DefineCommands();
+
     G4LogicalVolume* fScoringVolume = nullptr;
     G4LogicalVolume* fScoringVolumeCerenkov = nullptr;
+
+    Layout fLayout = Layout::Placement;
+    Envelope fEnvelope = Envelope::None;
+    RodModel fRodModel = RodModel::Nested;
+    Readout fReadout = Readout::Stepping;
+    ReadoutParameters fReadoutParameters;
+    DigitizerParameters fDigitizerParameters;
+    ChannelMap fChannelMap;
+    std::unique_ptr<G4UserLimits> fTimeLimits; // 径迹时间上限（G4UserSpecialCuts）
+    G4bool fCheckOverlaps = false;                       // Geant4 逐个放置的重叠检查（较慢）
+    G4String fOverlapCacheFile = "lattice_check.cache";  // 解析重叠检查的缓存文件
+    std::vector<G4ThreeVector> fFiberPositions;          // 孔内光纤位置（闪烁在前）
+    G4bool fTowerHasCore = false; // tower之间有间隙时多一层内芯体积
+    G4GenericMessenger* fMessenger = nullptr;
 };
 
 }
@@ -0,0 +1,74 @@
+/// \file B2/include/Digitizer.hh
+/// \brief Definition of the B2::Digitizer class
+
+#ifndef B2Digitizer_h
+#define B2Digitizer_h 1
+#include "globals.hh"
+#include "ChannelMap.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+class DigitizerParameters;
+class FiberHitsCollection;
+class PhotonSampler;
+
+/// SiPM/PMT digitisation of the photon counts of one event.
+///
+/// All 2 x nRods channels (digitiser channel = type*nRods + rod) live in
+/// structure-of-arrays buffers. Photo-detection is a binomial draw on the
+/// fired channels; crosstalk, afterpulses and dark counts are one batch
+/// Poisson draw over all channels; gain, pedestal, noise and ADC
+/// quantisation are branch-free loops over all channels that the compiler
+/// vectorises at -O3 (see CMakeLists.txt). Pixel saturation is a separate
+/// pass, as std::exp only vectorises with -ffast-math. The per-channel calibration is copied from
+/// DigitizerParameters whenever it changes.
+
+class Digitizer
+{
+  public:
+    Digitizer() = default;
+    ~Digitizer() = default;
+
+    void Digitize(const FiberHitsCollection* scintHits, const FiberHitsCollection* cerenkovHits,
+                  const DigitizerParameters& parameters, PhotonSampler& sampler);
+
+    G4int GetNumberOfRods() const { return fNRods; }
+    G4int GetChannel(FiberType type, G4int rod) const { return G4int(type)*fNRods + rod; }
+    G4int GetADC(G4int channel) const { return fADC[channel]; }
+    G4double GetPedestal(G4int channel) const { return fPedestal[channel]; }
+    // 超过零压缩阈值的通道（按通道号递增）
+    const std::vector<G4int>& GetFiredChannels() const { return fFired; }
+
+  private:
+    void Calibrate(const DigitizerParameters& parameters, G4int nRods);
+    void DetectPhotons(const DigitizerParameters& parameters, PhotonSampler& sampler);
+
+    static constexpr G4int kBinomialThreshold = 64; // 光子数高于此值时二项分布用正态近似
+
+    G4int fNRods = 0;
+    G4int fVersion = -1;
+    // 各通道（结构数组）
+    std::vector<G4double> fPhotons;     // 输入光子数
+    std::vector<G4double> fPE;          // 光电子数
+    std::vector<G4double> fExtraMean;   // 串扰 + 后脉冲 + 暗计数的平均值
+    std::vector<G4int> fExtra;
+    std::vector<G4double> fNormal;      // 基线噪声
+    std::vector<G4double> fSignal;      // 饱和后的点亮像素数
+    std::vector<G4double> fGain;
+    std::vector<G4double> fPedestal;
+    std::vector<G4double> fNoise;
+    std::vector<G4int> fADC;
+    // 有光子的通道
+    std::vector<G4int> fHit;
+    std::vector<G4double> fUniform;
+    std::vector<G4int> fFired;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
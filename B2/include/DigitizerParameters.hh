@@ -0,0 +1,110 @@
+/// \file B2/include/DigitizerParameters.hh
+/// \brief Definition of the B2::DigitizerParameters class
+
+#ifndef B2DigitizerParameters_h
+#define B2DigitizerParameters_h 1
+#include "globals.hh"
+#include "ChannelMap.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+namespace B2
+{
+
+/// Options of the SiPM/PMT digitisation, set through /B2/digi/.
+///
+/// Owned by DetectorConstruction and shared by all threads like
+/// ReadoutParameters. The per-channel gain, pedestal and noise default to the
+/// scalar values; /B2/digi/calibrationFile overrides individual channels.
+///
+/// With /B2/digi/waveform, each fired channel's arrival-time histogram is
+/// convolved with a single-photon pulse template (analytic rise/fall shape,
+/// or sampled values from /B2/digi/templateFile) at the ADC sampling period,
+/// see WaveformSynthesizer.
+
+class DigitizerParameters
+{
+  public:
+    struct Calibration {
+      FiberType type;
+      G4int rod;
+      G4double gain;       // ADC/光电子
+      G4double pedestal;   // ADC
+      G4double noise;      // 基线噪声 σ（ADC）
+    };
+
+    DigitizerParameters();
+    ~DigitizerParameters();
+
+    G4bool IsEnabled() const { return fEnabled; }
+    G4double GetPDE(FiberType type) const { return fPDE[G4int(type)]; }
+    G4int GetPixels() const { return fPixels; }
+    G4double GetCrosstalk() const { return fCrosstalk; }
+    G4double GetAfterpulse() const { return fAfterpulse; }
+    G4double GetDarkCountsPerWindow() const { return fDarkRate * fWindow; }
+    G4int GetADCMax() const { return (1 << fADCBits) - 1; }
+    G4double GetThreshold() const { return fThreshold; }
+    G4double GetGain() const { return fGain; }
+    G4double GetPedestal() const { return fPedestal; }
+    G4double GetNoise() const { return fNoise; }
+    const std::vector<Calibration>& GetCalibration() const { return fCalibration; }
+    // 每次修改参数加一，Digitizer 据此重建本线程的刻度表
+    G4int GetVersion() const { return fVersion; }
+
+    // 读取刻度文件，"none" 清除
+    void LoadCalibrationFile(G4String fileName);
+
+    // 波形模式
+    G4bool IsWaveformEnabled() const { return fWaveform; }
+    G4double GetSamplingPeriod() const { return fSamplingPeriod; }
+    G4int GetSamples() const { return fSamples; }
+    G4double GetWaveformThreshold() const { return fWaveformThreshold; }
+    G4bool GetWriteWaveforms() const { return fWriteWaveforms; }
+    G4double GetRiseTime() const { return fRiseTime; }
+    G4double GetFallTime() const { return fFallTime; }
+    // 文件中的单光子脉冲（按采样周期取样，峰值归一为1），空则用解析形状
+    const std::vector<G4double>& GetPulseTemplate() const { return fPulseTemplate; }
+
+    // 读取单光子脉冲模板文件（每行一个采样值），"none" 恢复解析形状
+    void LoadTemplateFile(G4String fileName);
+
+  private:
+    void DefineCommands();
+    void SetPixels(G4int pixels) { fPixels = pixels; fVersion++; }
+    void SetGain(G4double gain) { fGain = gain; fVersion++; }
+    void SetPedestal(G4double pedestal) { fPedestal = pedestal; fVersion++; }
+    void SetNoise(G4double noise) { fNoise = noise; fVersion++; }
+
+    G4bool fEnabled = false;
+    G4double fPDE[2] = { 0.35, 0.25 };     // 按 FiberType 索引
+    G4int fPixels = 10000;                 // SiPM 像素数，0 为 PMT（不饱和）
+    G4double fCrosstalk = 0.02;            // 每个光电子的光学串扰概率
+    G4double fAfterpulse = 0.01;           // 每个光电子的后脉冲概率（门内）
+    G4double fDarkRate = 100.*CLHEP::kilohertz;
+    G4double fWindow = 100.*CLHEP::ns;     // 积分时间（暗计数）
+    G4int fADCBits = 16;
+    G4double fThreshold = 10.;             // 零压缩阈值（高于台阶的 ADC）
+    G4double fGain = 2.;
+    G4double fPedestal = 100.;
+    G4double fNoise = 2.;
+    std::vector<Calibration> fCalibration;
+    G4bool fWaveform = false;
+    G4double fSamplingPeriod = 1.*CLHEP::ns;  // ADC 采样周期
+    G4int fSamples = 256;                     // 每个波形的采样数
+    G4double fWaveformThreshold = 0.5;        // 过阈时间的阈值（单光子峰值为1）
+    G4bool fWriteWaveforms = false;           // 除特征量外也写出原始波形
+    G4double fRiseTime = 1.*CLHEP::ns;        // 解析脉冲 (1-exp(-t/τr))·exp(-t/τf)
+    G4double fFallTime = 20.*CLHEP::ns;
+    std::vector<G4double> fPulseTemplate;
+    G4int fVersion = 0;
+    G4GenericMessenger* fMessenger = nullptr;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -6,13 +6,30 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 #include "G4SystemOfUnits.hh"
+#include "FiberHitsCollection.hh"
+#include "FiberResponse.hh"
+#include "PhotonSampler.hh"
+#include "Digitizer.hh"
+#include "WaveformSynthesizer.hh"
+
+#include <chrono>
+#include <memory>
 
 namespace B2
 {
 
 class RunAction;
+class DetectorConstruction;
 
 /// Event action class
+///
+/// The per-channel photon counts of an event come either from the fiber
+/// hits collections of FiberSD (sd readout) or from two collections owned by
+/// this class and filled by SteppingAction (stepping readout). The counts
+/// are drawn at end of event with one batch PhotonSampler call per collection,
+/// then restricted to the integration gate of the ReadoutParameters and,
+/// with /B2/digi/enable, passed through the Digitizer; /B2/digi/waveform
+/// adds the WaveformSynthesizer features.
 
 class EventAction : public G4UserEventAction
 {
@@ -23,10 +40,18 @@ class EventAction : public G4UserEventAction
     void BeginOfEventAction(const G4Event* event) override;  // 事例开始时初始化数据
     void EndOfEventAction(const G4Event* event) override;  // 事例结束时传递数据
 
-    // 闪烁光子数累加接口（供SteppingAction调用）
-    void AddScintPhotons(G4int nPhoton) { fScintPhotonTotal += nPhoton; }
-    // 切伦科夫光子数累加接口（供SteppingAction调用）
-    void AddCerenkovPhotons(G4int nPhoton) { fCerenkovPhotonTotal += nPhoton; }
+    // 光子数累加接口（供SteppingAction调用，channel 为铜棒编号）：
+    // 逐步抽样时缓存本步平均光子数，延迟抽样时按通道、时间格累加平均光子数
+    void AddStepPhotons(FiberType type, G4int channel, G4double meanPhotons, G4double time) {
+      (type == FiberType::Scint ? fScintHits : fCerenkovHits)->AddStep(channel, meanPhotons, time);
+    }
+    void AddMeanPhotons(FiberType type, G4int channel, G4double meanPhotons, G4double time) {
+      (type == FiberType::Scint ? fScintHits : fCerenkovHits)->AddMean(channel, meanPhotons, time);
+    }
+
+    // 步数计数（步进速率统计用）
+    void CountStep() { ++fNSteps; }
+    void CountFiberStep() { ++fNFiberSteps; }
 
     // 获取累加后的总光子数（供RunAction调用）
     G4int GetScintPhotonTotal() const { return fScintPhotonTotal; }
@@ -34,9 +59,27 @@ class EventAction : public G4UserEventAction
 
 
   private:
+    // 取得本事例的两个光纤读出集合（sd 模式来自 HCE，stepping 模式为自有缓冲）
+    void CollectHits(const G4Event* event);
+
     RunAction* fRunAction = nullptr;  // 指向RunAction，用于传递数据
+    const DetectorConstruction* fDetector = nullptr;
+    G4bool fUseSD = false;            // 读出方式：FiberSD 或 SteppingAction
+    std::unique_ptr<FiberHitsCollection> fOwnScintHits;
+    std::unique_ptr<FiberHitsCollection> fOwnCerenkovHits;
+    FiberHitsCollection* fScintHits = nullptr;
+    FiberHitsCollection* fCerenkovHits = nullptr;
+    G4int fRunID = -1;                // 自有集合的时间分格所属的 run
+    G4int fScintHCID = -1;
+    G4int fCerenkovHCID = -1;
+    PhotonSampler fSampler;           // 事例结束时批量泊松抽样
+    Digitizer fDigitizer;             // SiPM/PMT 数字化（/B2/digi/enable）
+    WaveformSynthesizer fWaveforms;   // 波形与特征量（/B2/digi/waveform）
     G4int fScintPhotonTotal = 0;    // 单个事例闪烁光子总数
     G4int fCerenkovPhotonTotal = 0; // 单个事例切伦科夫光子总数
+    G4long fNSteps = 0;             // 单个事例的步数
+    G4long fNFiberSteps = 0;        // 其中落在光纤内的步数
+    std::chrono::steady_clock::time_point fEventStart;  // 事例耗时（负载均衡的代价模型）
     const G4double fCollectionEfficiency = 0.9;  // 固定参数（收集效率，也可作为全局参数定义）
 
 };
@@ -0,0 +1,85 @@
+/// \file B2/include/EventQueue.hh
+/// \brief Definition of the B2::EventRecord struct and the B2::EventQueue class
+
+#ifndef B2EventQueue_h
+#define B2EventQueue_h 1
+#include "globals.hh"
+
+#include <atomic>
+#include <vector>
+
+namespace B2
+{
+
+/// Output record of one event.
+///
+/// The records live in the preallocated slots of an EventQueue; the vectors
+/// keep their capacity from event to event and are filled by swapping, so a
+/// record costs no allocation once the queue has warmed up.
+
+struct EventRecord
+{
+  G4int eventID = 0;
+  G4int scintTotal = 0;
+  G4int cerenkovTotal = 0;
+  G4double energy = 0.;               // 初级粒子动能（MeV）
+  std::vector<G4int> scintTower;      // 各 tower 的和（定长）
+  std::vector<G4int> cerenkovTower;
+  std::vector<G4int> scintChannel;    // 零压缩的铜棒读出
+  std::vector<G4int> scintCount;
+  std::vector<G4int> cerenkovChannel;
+  std::vector<G4int> cerenkovCount;
+};
+
+/// Lock-free single-producer single-consumer ring buffer of event records.
+///
+/// The producer (one worker thread) claims the slot at the head, fills it and
+/// publishes it; the consumer (the writer thread) peeks the slot at the tail
+/// and releases it once written. The capacity is rounded up to a power of two.
+
+class EventQueue
+{
+  public:
+    explicit EventQueue(std::size_t capacity);
+    ~EventQueue() = default;
+
+    // 生产者：取得可写的槽，队列满时返回 nullptr
+    EventRecord* Claim() {
+      std::size_t head = fHead.load(std::memory_order_relaxed);
+      if (head - fTail.load(std::memory_order_acquire) > fMask) return nullptr;
+      return &fSlots[head & fMask];
+    }
+    void Publish() { fHead.store(fHead.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // 消费者：取得最早的记录，队列空时返回 nullptr
+    EventRecord* Peek() {
+      std::size_t tail = fTail.load(std::memory_order_relaxed);
+      if (fHead.load(std::memory_order_acquire) == tail) return nullptr;
+      return &fSlots[tail & fMask];
+    }
+    void Release() { fTail.store(fTail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    std::size_t Size() const {
+      return fHead.load(std::memory_order_acquire) - fTail.load(std::memory_order_acquire);
+    }
+    std::size_t Capacity() const { return fMask + 1; }
+
+    // 改变容量：只能在队列为空、生产者与写线程都不运行时调用（两次 run 之间）
+    void Resize(std::size_t capacity);
+
+    // 背压统计（生产者写，写线程在 run 结束时读）
+    std::atomic<G4long> fStalls{0};       // 队列满而等待的次数
+    std::atomic<G4double> fStallTime{0.}; // 等待的总时间（秒）
+
+  private:
+    std::vector<EventRecord> fSlots;
+    std::size_t fMask = 0;
+    alignas(64) std::atomic<std::size_t> fHead{0}; // 生产者写入位置
+    alignas(64) std::atomic<std::size_t> fTail{0}; // 消费者读取位置
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
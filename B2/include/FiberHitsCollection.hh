@@ -0,0 +1,126 @@
+/// \file B2/include/FiberHitsCollection.hh
+/// \brief Definition of the B2::FiberHitsCollection class
+
+#ifndef B2FiberHitsCollection_h
+#define B2FiberHitsCollection_h 1
+#include "G4VHitsCollection.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+class PhotonSampler;
+
+/// Photon counts of one fiber type for one event.
+///
+/// Instead of one G4VHit per step (or a std::map based G4THitsMap), the
+/// collection is a flat array with one entry per readout channel (rod),
+/// allocated once with the number of channels, plus the list of fired
+/// channels for sparse loops and clearing.
+/// The photon counts are drawn at end of event by Sample() with the batch
+/// PhotonSampler: per-step means are buffered with AddStep() (one draw per
+/// step), deferred sampling sums them per channel with AddMean() (one draw
+/// per channel and time bin). The step buffer holds at most
+/// kMaxBufferedSteps steps; beyond that the buffered steps are folded into
+/// the per-channel sums, which leaves the distribution of the counts unchanged.
+/// Every contribution carries its photon arrival time; the counts are kept
+/// in per-channel time bins (the last bin collects everything later), and
+/// ApplyGate() restricts the channel counts to the integration gate, never
+/// including that last (overflow) bin.
+
+class FiberHitsCollection : public G4VHitsCollection
+{
+  public:
+    FiberHitsCollection(const G4String& detName, const G4String& colName, G4int nChannels);
+    ~FiberHitsCollection() override = default;
+
+    // 到达时间分格（分格数或宽度改变时重新分配并清空）
+    void SetTimeBinning(G4int nBins, G4double binWidth);
+    G4int GetNumberOfTimeBins() const { return fNTimeBins; }
+    G4double GetTimeBinWidth() const { return fTimeBinWidth; }
+
+    void Add(G4int channel, G4int timeBin, G4int nPhotons) {
+      if (nPhotons <= 0) return;
+      if (fPhotons[channel] == 0 && fMean[channel] == 0.) fFired.push_back(channel);
+      fPhotons[channel] += nPhotons;
+      fBinPhotons[channel*fNTimeBins + timeBin] += nPhotons;
+      fTimeProfile[timeBin] += nPhotons;
+      fTotal += nPhotons;
+    }
+
+    // 逐步抽样：缓存本步的平均光子数与到达时间，事例结束时批量抽样
+    // （缓存满 kMaxBufferedSteps 步时并入按通道、时间格的累计平均值，内存有上限）
+    void AddStep(G4int channel, G4double meanPhotons, G4double time) {
+      if (meanPhotons <= 0.) return;
+      if (fStepMean.size() == kMaxBufferedSteps) FoldSteps();
+      fStepChannel.push_back(channel);
+      fStepMean.push_back(meanPhotons);
+      fStepBin.push_back(TimeBin(time));
+    }
+
+    // 延迟抽样：按通道和时间格累加平均光子数
+    void AddMean(G4int channel, G4double meanPhotons, G4double time) {
+      if (meanPhotons <= 0.) return;
+      if (fPhotons[channel] == 0 && fMean[channel] == 0.) fFired.push_back(channel);
+      fMean[channel] += meanPhotons;
+      fBinMean[channel*fNTimeBins + TimeBin(time)] += meanPhotons;
+    }
+
+    // 对缓存的步和各通道、各时间格的累计平均值批量泊松抽样（独立泊松变量之和仍为泊松分布）
+    void Sample(PhotonSampler& sampler);
+
+    // 积分门：通道光子数只计 [firstBin, endBin) 内的时间格（不含最后的溢出格）
+    void ApplyGate(G4int firstBin, G4int endBin);
+
+    // 只清除被击中的通道
+    void Clear();
+
+    G4int GetPhotons(G4int channel) const { return fPhotons[channel]; }
+    G4int GetPhotons(G4int channel, G4int timeBin) const {
+      return fBinPhotons[channel*fNTimeBins + timeBin];
+    }
+    G4int GetTotal() const { return fTotal; }
+    G4int GetNumberOfChannels() const { return G4int(fPhotons.size()); }
+    const std::vector<G4int>& GetFiredChannels() const { return fFired; }
+    // 所有通道各时间格光子数之和（不受积分门影响）
+    const std::vector<G4int>& GetTimeProfile() const { return fTimeProfile; }
+
+    std::size_t GetSize() const override { return fPhotons.size(); }
+
+    static constexpr std::size_t kMaxBufferedSteps = 65536;
+
+  private:
+    // 把缓存的步并入 fMean/fBinMean（分布不变：独立泊松变量之和仍为泊松分布）
+    void FoldSteps();
+
+    G4int TimeBin(G4double time) const {
+      if (time <= 0.) return 0;
+      G4double bin = time * fInvTimeBinWidth;
+      return bin < fNTimeBins - 1 ? G4int(bin) : fNTimeBins - 1;
+    }
+
+    std::vector<G4int> fPhotons; // 各通道光子数
+    std::vector<G4double> fMean; // 各通道累计平均光子数（延迟抽样）
+    std::vector<G4int> fFired;   // 被击中的通道
+    G4int fNTimeBins = 1;
+    G4double fTimeBinWidth = 0.;
+    G4double fInvTimeBinWidth = 0.;
+    std::vector<G4int> fBinPhotons;    // 通道×时间格的光子数
+    std::vector<G4double> fBinMean;    // 通道×时间格的累计平均光子数（延迟抽样）
+    std::vector<G4int> fTimeProfile;   // 各时间格光子数
+    std::vector<G4int> fStepChannel;   // 缓存的步（逐步抽样）
+    std::vector<G4double> fStepMean;
+    std::vector<G4int> fStepBin;
+    std::vector<G4int> fCounts;        // 批量抽样结果
+    std::vector<G4double> fMeanBuffer;
+    std::vector<G4int> fIndexBuffer;   // 延迟抽样时各平均值对应的 通道×时间格 下标
+    G4int fTotal = 0;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,78 @@
+/// \file B2/include/FiberResponse.hh
+/// \brief Definition of the B2::FiberResponse class
+
+#ifndef B2FiberResponse_h
+#define B2FiberResponse_h 1
+#include "globals.hh"
+#include "ChannelMap.hh"
+#include "LightTransport.hh"
+#include "G4PhysicsLogVector.hh"
+#include "CLHEP/Units/SystemOfUnits.h" // 单位头文件CLHEP
+
+#include <vector>
+
+class G4Step;
+class G4ParticleDefinition;
+
+namespace B2
+{
+
+class ReadoutParameters;
+
+/// Photon yield of a fiber step.
+///
+/// Shared by SteppingAction and FiberSD so that both readout paths use the same
+/// scintillation and Cerenkov yield; the counts are drawn by PhotonSampler.
+/// The Cerenkov yield dN/dx is tabulated against kinetic energy per particle
+/// species (indexed by G4ParticleDefinition::GetParticleDefinitionID()), together
+/// with the species' kinetic-energy threshold. A table is filled from fRefIndex
+/// the first time a species is seen in a run; BeginOfRun() drops the tables.
+/// Both yields are scaled by the LightTransport response at the step midpoint
+/// in the fiber frame, which includes the collection efficiency and gives the
+/// propagation delay of the photon arrival time.
+
+class FiberResponse
+{
+  public:
+    FiberResponse() = default;
+    ~FiberResponse() = default;
+
+    // 每个 run 开始时调用：读取读出参数，清空切伦科夫产额表，重建光传输表
+    void BeginOfRun(const ReadoutParameters& parameters, G4double fiberLength);
+
+    // 产生的光子数：闪烁 = 沉积能量×产额；切伦科夫 = dN/dx×步长（中性或低于阈值为0）
+    G4double ScintillationMean(const G4Step* step) const;
+    G4double CerenkovMean(const G4Step* step);
+
+    // 到达读出端的平均光子数（乘以光传输响应），time 返回到达时间（步中点全局时间 + 传播时间）
+    G4double MeanPhotons(FiberType type, const G4Step* step, G4double& time);
+
+  private:
+    // 单个粒子种类的切伦科夫产额表
+    struct CerenkovTable {
+      G4bool built = false;
+      G4double threshold = DBL_MAX;  // 动能阈值（中性粒子为 DBL_MAX）
+      G4PhysicsLogVector dNdx;       // 单位长度光子数对动能
+    };
+    const CerenkovTable& GetCerenkovTable(const G4ParticleDefinition* particle);
+    void BuildCerenkovTable(const G4ParticleDefinition* particle, CerenkovTable& table) const;
+
+    // 固定参数
+    const G4double fScintillationYield = 10000.0 / CLHEP::MeV; // 闪烁产额
+    const G4double fRefIndex = 1.458; // 切伦科夫效应折射率
+    const G4double fBetaThreshold = 1.0 / fRefIndex; // 切伦科夫阈值β
+    const G4double fCerenkovDNdx = 369.0 / CLHEP::cm; // β→1 时 dN/dx 的系数
+    const G4int fTableDecades = 4;      // 产额表范围：阈值 ~ 阈值×10^4（之上已饱和）
+    const G4int fTableBinsPerDecade = 50;
+
+    G4bool fAverageBeta = false;
+    LightTransport fTransport;
+    std::vector<CerenkovTable> fCerenkovTables; // 按粒子定义 ID 索引
+    CerenkovTable fNoYield;                      // 无 ID 的粒子：不产生光子
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
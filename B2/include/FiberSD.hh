@@ -0,0 +1,54 @@
+/// \file B2/include/FiberSD.hh
+/// \brief Definition of the B2::FiberSD class
+
+#ifndef B2FiberSD_h
+#define B2FiberSD_h 1
+#include "G4VSensitiveDetector.hh"
+#include "FiberResponse.hh"
+#include "FiberHitsCollection.hh"
+
+#include <memory>
+
+class G4Step;
+class G4HCofThisEvent;
+
+namespace B2
+{
+
+class DetectorConstruction;
+
+/// Fiber sensitive detector.
+///
+/// One instance is attached to LogicScintFiber and one to LogicCerenkovFiber.
+/// In ProcessHits() the mean photon yield of the step is computed with
+/// FiberResponse and booked for the channel of the rod that holds the fiber;
+/// EventAction samples the counts at end of event.
+/// The collection is allocated once per thread and cleared at the start of
+/// each event; it is only lent to the HCE (EventAction::CollectHits removes
+/// it again, so that the event does not delete it).
+
+class FiberSD : public G4VSensitiveDetector
+{
+  public:
+    FiberSD(const G4String& name, const G4String& hitsCollectionName,
+            FiberType type, const DetectorConstruction* detector);
+    ~FiberSD() override = default;
+
+    // methods from base class
+    void   Initialize(G4HCofThisEvent* hitCollection) override;
+    G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+
+  private:
+    FiberType fType;
+    const DetectorConstruction* fDetector = nullptr;
+    FiberResponse fResponse;
+    std::unique_ptr<FiberHitsCollection> fHitsCollection;
+    G4int fHitsCollectionID = -1;
+    G4int fRunID = -1;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,70 @@
+/// \file B2/include/LatticeValidator.hh
+/// \brief Definition of the B2::LatticeValidator class
+
+#ifndef B2LatticeValidator_h
+#define B2LatticeValidator_h 1
+#include "globals.hh"
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace B2
+{
+
+/// Geometry constants checked by LatticeValidator.
+
+struct LatticeGeometry
+{
+  G4double rodX = 0.;
+  G4double rodY = 0.;
+  G4double rodLength = 0.;
+  G4double holeR = 0.;
+  G4double fiberR = 0.;
+  G4double rodSpacing = 0.;
+  G4double towerSpacing = 0.;
+  G4int rodPerTower = 0;
+  G4int towerPerSide = 0;
+  G4double worldXY = 0.;
+  G4double worldZ = 0.;
+  G4RotationMatrix rotation;             // 探测器旋转（G4PVPlacement约定的坐标系旋转）
+  G4bool rotatePerRod = false;           // true：每根铜棒绕自身中心旋转；false：整个量能器旋转
+  std::vector<G4ThreeVector> fiberPos;   // 孔内各光纤中心位置
+};
+
+/// Analytic overlap validator for the rod lattice.
+///
+/// Instead of surface-sampling every placement, it checks the lattice spacing
+/// against the rod, hole and fiber dimensions and the detector rotation.
+/// The result is cached in a small text file keyed by a hash of the geometry
+/// constants, so the check only runs again when one of them changes.
+
+class LatticeValidator
+{
+  public:
+    LatticeValidator(const LatticeGeometry& geometry);
+    ~LatticeValidator() = default;
+
+    // 读取缓存；缓存不存在或哈希不一致时重新检查并写缓存。返回是否无重叠
+    G4bool Validate(const G4String& cacheFile) const;
+
+    // 解析检查，problems 中返回发现的问题
+    G4bool Check(std::vector<G4String>& problems) const;
+
+    std::uint64_t GetHash() const;
+
+  private:
+    G4bool CheckRodNeighbours(std::vector<G4String>& problems) const;
+    G4bool CheckContainment(std::vector<G4String>& problems) const;
+    G4bool CheckRodInternals(std::vector<G4String>& problems) const;
+
+    LatticeGeometry fGeometry;
+    G4double fTolerance;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,63 @@
+/// \file B2/include/LightTransport.hh
+/// \brief Definition of the B2::LightTransport class
+
+#ifndef B2LightTransport_h
+#define B2LightTransport_h 1
+#include "globals.hh"
+#include "ChannelMap.hh"
+
+#include <algorithm>
+#include <vector>
+
+namespace B2
+{
+
+class ReadoutParameters;
+
+/// Light transport along the fibers to the readout at the rear (+z) end.
+///
+/// For light produced at local fiber z the collected fraction is
+///   eff * (T(d) + R * T(2L - d)),  d = L/2 - z,
+/// with the collection efficiency eff of the light heading to the readout,
+/// the transmission T of the fiber type and the reflectivity R of the front
+/// mirror. It is tabulated in z bins at run start together with the
+/// propagation delay d*n_g/c of the direct light; Lookup() is one read.
+
+class LightTransport
+{
+  public:
+    LightTransport() = default;
+    ~LightTransport() = default;
+
+    // 每个 run 开始时按读出参数与光纤长度重建两种光纤的表
+    void Build(const ReadoutParameters& parameters, G4double fiberLength);
+
+    // response：光纤局部坐标 z 处产生的光到达读出端的比例（含收集效率）；delay：传播时间
+    struct Point {
+      G4double response;
+      G4double delay;
+    };
+    const Point& Lookup(FiberType type, G4double z) const {
+      G4int bin = G4int((z + fHalfLength) * fInvBinWidth);
+      bin = std::min(std::max(bin, 0), fNBins - 1);
+      return fTable[G4int(type)][bin];
+    }
+    G4double Response(FiberType type, G4double z) const { return Lookup(type, z).response; }
+
+  private:
+    G4double Transmission(const ReadoutParameters& parameters, FiberType type,
+                          G4double distance) const;
+
+    const G4double fCollectionEfficiency = 0.9; // 光子收集效率（朝读出端的光）
+    const G4int fNBins = 400;                   // 2 m 光纤时每格 5 mm
+
+    G4double fHalfLength = 0.;
+    G4double fInvBinWidth = 0.;
+    std::vector<Point> fTable[2];               // 按 FiberType 索引
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,79 @@
+/// \file B2/include/LoadBalancer.hh
+/// \brief Definition of the B2::LoadBalancer class
+
+#ifndef B2LoadBalancer_h
+#define B2LoadBalancer_h 1
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace B2
+{
+
+/// Per-event cost model and load-balance statistics of the event loop.
+///
+/// Every event reports its primary energy and wall time (EventAction). The
+/// cost model t(E) = c0 + c1*E is a least-squares fit with exponential
+/// forgetting, so it follows the recent history. BalancedRunManager asks for
+/// the size of each chunk of events handed to a worker: the next events are
+/// taken until their estimated cost reaches the remaining cost divided by
+/// twice the number of threads (guided self-scheduling weighted by energy),
+/// so chunks shrink towards the end of the run and no worker is left with a
+/// long tail. The energies of the coming events are taken from the master's
+/// PrimaryGeneratorAction (scan points, energy list or the expected energy).
+///
+/// The per-worker busy time and finish time are printed at the end of each
+/// run, with either run manager.
+
+class LoadBalancer
+{
+  public:
+    static LoadBalancer& Instance();
+
+    // 主线程：run 开始时（各事例的预计能量，GeV）
+    void BeginRun(G4int nEvents, std::function<G4double(G4int)> plannedEnergy);
+    // 工作线程：每个事例结束时
+    void RecordEvent(G4double energy, G4double seconds);
+    // 工作线程：事例循环结束时
+    void WorkerFinished();
+
+    // 从 firstEvent 起交给一个工作线程的事例数
+    G4int ChunkSize(G4int firstEvent, G4int remaining, G4int nThreads);
+
+    // 主线程：run 结束时打印各线程的忙碌时间与结束时间（接在 run 汇总行之后）
+    void PrintStatistics() const;
+
+  private:
+    LoadBalancer() = default;
+
+    struct Worker {
+      G4int events = 0;
+      G4double busy = 0.;      // 事例耗时之和（s）
+      G4double finished = -1.; // 事例循环结束的时刻（相对 run 开始，s）
+    };
+
+    // 加权拟合 t = c0 + c1*E，未能拟合时按能量成正比
+    void CostModel(G4double& c0, G4double& c1) const;
+    G4double ElapsedSeconds() const;
+
+    mutable std::mutex fMutex;
+    std::chrono::steady_clock::time_point fRunStart;
+    std::vector<G4double> fEnergySum;   // 预计能量的前缀和（GeV）
+    std::vector<Worker> fWorkers;       // 按线程号
+    G4int fChunks = 0;
+    G4int fMinChunk = 0;
+    G4int fMaxChunk = 0;
+    // 带遗忘因子的最小二乘累加量
+    G4double fW = 0., fE = 0., fEE = 0., fT = 0., fET = 0.;
+    static constexpr G4double fForget = 0.99;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,137 @@
+/// \file B2/include/OutputSink.hh
+/// \brief Definition of the B2::OutputSink, B2::RawSink and B2::ColumnarSink classes
+
+#ifndef B2OutputSink_h
+#define B2OutputSink_h 1
+#include "globals.hh"
+#include "EventQueue.hh"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace B2
+{
+
+/// Destination of the event records drained by AsyncWriter.
+/// Only the writer thread calls it. The records (EventRecord) hold the photon
+/// counts only: the Digitizer and WaveformSynthesizer outputs go to the root
+/// ntuple alone. A failed write stops further output to the file; Close()
+/// then reports it with a B2Output003 warning, and GetBytesWritten() counts
+/// only the bytes that reached the file.
+
+class OutputSink
+{
+  public:
+    virtual ~OutputSink() = default;
+
+    virtual G4bool Open(const G4String& fileName, G4int nTowers) = 0;
+    virtual void Write(const EventRecord& record) = 0;
+    virtual void Close() = 0;
+
+    // 实际写出的字节数
+    virtual G4double GetBytesWritten() const = 0;
+};
+
+/// Row-wise binary file: an 8-byte magic "B2RAW01" and the number of towers,
+/// then per event the int32 eventID, S, C, the float64 primary energy (MeV),
+/// the int32 S and C tower sums, and for S and C the number of fired rods
+/// followed by their channel IDs and counts. Records are collected in a large
+/// buffer and written with fwrite.
+
+class RawSink : public OutputSink
+{
+  public:
+    RawSink() = default;
+    ~RawSink() override;
+
+    G4bool Open(const G4String& fileName, G4int nTowers) override;
+    void Write(const EventRecord& record) override;
+    void Close() override;
+    G4double GetBytesWritten() const override { return fBytesWritten; }
+
+  private:
+    void Append(const void* data, std::size_t bytes);
+    void Flush();
+
+    G4String fFileName;
+    std::FILE* fFile = nullptr;
+    std::vector<char> fBuffer;
+    G4double fBytesWritten = 0.;
+    G4bool fFailed = false;         // fwrite 未写完，之后的记录被丢弃
+    static constexpr std::size_t kBufferSize = 4 << 20; // 4 MB 缓冲
+};
+
+/// Append-only file written through a sliding memory map (POSIX) or large
+/// fwrite calls (elsewhere); used for the columns of ColumnarSink. When the
+/// file cannot be extended or mapped, HasFailed() is set and the rest of the
+/// data is dropped; GetSize() counts what was written before.
+
+class ColumnFile
+{
+  public:
+    ColumnFile() = default;
+    ~ColumnFile();
+
+    G4bool Open(const G4String& path);
+    void Append(const void* data, std::size_t bytes);
+    void Close();
+    std::size_t GetSize() const { return fSize; }
+    G4bool HasFailed() const { return fFailed; }
+
+  private:
+    void Remap();
+
+    std::size_t fSize = 0;          // 已写入的字节数
+    G4bool fFailed = false;         // ftruncate/mmap/fwrite 失败
+#if defined(__unix__) || defined(__APPLE__)
+    int fFd = -1;
+    char* fMap = nullptr;           // 当前映射窗口
+    std::size_t fMapOffset = 0;     // 映射窗口在文件中的位置
+    std::size_t fMapUsed = 0;       // 窗口内已写入的字节数
+#else
+    std::FILE* fFile = nullptr;
+#endif
+    static constexpr std::size_t kChunk = 8 << 20; // 每次映射 8 MB
+};
+
+/// Columnar output: a directory <fileName>.b2col with one fixed-width file per
+/// column (eventID, S, C: int32; energy: float64 in MeV; S/C tower sums: int32
+/// x nTowers per event), the zero-suppressed channel vectors as flat int32
+/// files, and for each vector pair an int64 offsets file with nEvents+1 entries.
+/// schema.txt, written on Close(), lists the columns, their types and widths
+/// and the number of events; it is not written when a column file failed, so
+/// that an incomplete directory is not read as a valid one.
+
+class ColumnarSink : public OutputSink
+{
+  public:
+    ColumnarSink() = default;
+    ~ColumnarSink() override;
+
+    G4bool Open(const G4String& fileName, G4int nTowers) override;
+    void Write(const EventRecord& record) override;
+    void Close() override;
+    G4double GetBytesWritten() const override;
+
+  private:
+    enum Column {
+      kEventID, kScint, kCerenkov, kEnergy, kScintTower, kCerenkovTower,
+      kScintChannel, kScintCount, kScintOffsets,
+      kCerenkovChannel, kCerenkovCount, kCerenkovOffsets, kNColumns
+    };
+
+    G4String fDirectory;
+    G4int fNTowers = 0;
+    G4long fNEvents = 0;
+    G4bool fOpen = false;
+    G4long fScintOffset = 0;        // 已写出的通道数（偏移量文件的下一个值）
+    G4long fCerenkovOffset = 0;
+    std::unique_ptr<ColumnFile> fColumns[kNColumns];
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
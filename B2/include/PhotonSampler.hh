@@ -0,0 +1,61 @@
+/// \file B2/include/PhotonSampler.hh
+/// \brief Definition of the B2::PhotonSampler class
+
+#ifndef B2PhotonSampler_h
+#define B2PhotonSampler_h 1
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace B2
+{
+
+/// Batch Poisson sampler for photon counts.
+///
+/// Fills an array of counts from an array of means in one call. The uniform
+/// numbers come from a counter-based generator (SplitMix64 of key + counter),
+/// so the generation loop has no engine state and no virtual call per number;
+/// the key is drawn once per event from G4Random. Below kGaussThreshold a
+/// mean is split into a grid value j/4 and a remainder r < 1/4: the first
+/// part is inverted from a precomputed CDF table (branch-free binary search
+/// with a trip count fixed by the table), the remainder from a fixed number
+/// of CDF terms, and the two counts are added (the sum of independent
+/// Poisson variables is Poisson). Larger means use the normal approximation
+/// with continuity and skewness correction.
+
+class PhotonSampler
+{
+  public:
+    PhotonSampler() = default;
+    ~PhotonSampler() = default;
+
+    // 每个事例开始时调用：由 G4Random 引擎取密钥，计数器清零
+    void SeedFromEngine();
+    void SetKey(std::uint64_t key) { fKey = key; fCounter = 0; }
+
+    // counts[i] ~ Poisson(means[i])，means[i] <= 0 时为 0
+    void Sample(const G4double* means, G4int* counts, std::size_t n);
+
+    // 同一计数器流上的 (0,1) 均匀数与标准正态数（供 Digitizer 使用）
+    void Uniform(G4double* u, std::size_t n);
+    void Normal(G4double* z, std::size_t n);
+
+    // 与 CLHEP::RandPoisson 的速度与统计对比（/B2/readout/benchSampler）
+    static void Benchmark(G4int nSamples);
+
+    static constexpr G4double kGaussThreshold = 64.; // 高于此平均值用正态近似
+
+  private:
+    std::uint64_t fKey = 0;
+    std::uint64_t fCounter = 0;
+    std::vector<G4double> fU; // 批量均匀随机数（逆变换 / Box-Muller 半径）
+    std::vector<G4double> fV; // Box-Muller 角度 / 小平均值余量部分的均匀数
+    std::vector<G4double> fResidual; // 余量部分的泊松数
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -6,10 +6,14 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
 #include "globals.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <vector>
 
 class G4ParticleGun;
 class G4Event;
 class G4Box;
+class G4GenericMessenger;
 
 namespace B2
 {
@@ -18,10 +22,27 @@ namespace B2
 ///
 /// The default kinematic is a 6 MeV gamma, randomly distribued
 /// in front of the phantom across 80% of the (X,Y) phantom size.
+///
+/// /B2/scan/ runs several beam energies as one job: /B2/scan/add queues an
+/// energy point with its number of events and /B2/scan/beamOn starts a single
+/// run with all of them, so the workers do not drain and restart between the
+/// points. While the scan is enabled the event ID selects the point; the
+/// points are ordered by decreasing energy, so the costly events are handed
+/// out first and the end of the run only waits on cheap ones. The gun
+/// energy itself is left untouched.
+///
+/// /B2/spectrum/ draws the beam energy per event instead: list cycles through
+/// a list of energies by event ID (interleaved), logUniform samples between
+/// /B2/spectrum/min and max, histogram samples a user-supplied spectrum. The
+/// reconstruction accumulators are binned in energy (list entries, log bins
+/// or the histogram bins), so response and resolution curves come from one
+/// run. A running scan takes precedence over the spectrum.
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
   public:
+    enum class Spectrum { Fixed, List, LogUniform, Histogram };
+
     PrimaryGeneratorAction();
     ~PrimaryGeneratorAction() override;
 
@@ -31,9 +52,58 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     // method to access particle gun
     const G4ParticleGun* GetParticleGun() const { return fParticleGun; }
 
+    // 能量扫描：扫描点数（未开启扫描时为 0）、事例所属的扫描点（未开启时为 -1）与能量
+    G4int GetNumberOfScanPoints() const { return fScanEnabled ? G4int(fScanPoints.size()) : 0; }
+    G4int GetScanPoint(G4int eventID) const;
+    G4double GetScanEnergy(G4int point) const { return fScanPoints[point].energy; }
+    // 本 run 的最高束流能量（直方图范围）
+    G4double GetMaxEnergy() const;
+
+    // 重建累加量的能量分箱：扫描点、能谱分箱，或单个分箱
+    G4int GetNumberOfEnergyBins() const;
+    G4int GetEnergyBin(G4int eventID, G4double energy) const;
+
+    // 事例的预计能量（负载均衡用）：扫描点或列表中的能量，随机能谱取期望值
+    G4double GetPlannedEnergy(G4int eventID) const;
+
   private:
+    struct ScanPoint {
+      G4double energy;
+      G4int events;
+    };
+
+    void AddScanPoint(G4String values);
+    void ClearScan();
+    void ScanBeamOn();
+    void SetSpectrum(G4String name);
+    void SetEnergyList(G4String values);
+    // /B2/spectrum/min、max：logUniform 正在使用时重新检查 0 < min < max
+    void SetMinEnergy(G4double energy) { SetEnergyRange(energy, fMaxEnergy); }
+    void SetMaxEnergy(G4double energy) { SetEnergyRange(fMinEnergy, energy); }
+    void SetEnergyRange(G4double minEnergy, G4double maxEnergy);
+    G4bool HasLogRange() const { return fMaxEnergy > fMinEnergy && fMinEnergy > 0.; }
+    void LoadSpectrumFile(G4String fileName);
+    // 按能谱抽取本事例的能量（Fixed 时为枪的能量）
+    G4double SampleEnergy(G4int eventID) const;
+    void DefineCommands();
+
     G4ParticleGun* fParticleGun = nullptr; // pointer a to G4 gun class
-   
+
+    std::vector<ScanPoint> fScanPoints;   // 按添加顺序
+    std::vector<G4int> fScanOrder;        // 按能量从高到低的扫描点
+    std::vector<G4int> fScanEnd;          // fScanOrder 中各点最后一个事例号 + 1
+    G4bool fScanEnabled = false;
+    G4GenericMessenger* fMessenger = nullptr;
+
+    // 逐事例能谱（/B2/spectrum/）
+    Spectrum fSpectrum = Spectrum::Fixed;
+    std::vector<G4double> fEnergyList;    // list：按事例号轮流
+    G4double fMinEnergy = 10*CLHEP::GeV;  // logUniform 的范围
+    G4double fMaxEnergy = 300*CLHEP::GeV;
+    G4int fLogBins = 10;                  // logUniform 的累加量分箱数
+    std::vector<G4double> fEdges;         // histogram：分箱边界（nBins + 1 个）
+    std::vector<G4double> fCumulative;    // histogram：各分箱上边界处的累积概率
+    G4GenericMessenger* fSpectrumMessenger = nullptr;
 };
 
 }
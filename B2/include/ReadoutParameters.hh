@@ -0,0 +1,99 @@
+/// \file B2/include/ReadoutParameters.hh
+/// \brief Definition of the B2::ReadoutParameters class
+
+#ifndef B2ReadoutParameters_h
+#define B2ReadoutParameters_h 1
+#include "globals.hh"
+#include "ChannelMap.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+namespace B2
+{
+
+/// Run-time options of the photon readout, set through /B2/readout/.
+///
+/// Owned by DetectorConstruction and shared by all threads: the commands are
+/// executed on the master between runs, the workers only read the values.
+///
+/// The light transport along the fibers (see LightTransport) is set by one
+/// attenuation length per fiber type, optionally replaced by a measured
+/// transmission curve read from /B2/readout/attenuationFile, and by the
+/// reflectivity of a mirror on the front end (0 = no mirror).
+///
+/// Photon arrival time = global time of the step + propagation delay to the
+/// readout with the group index of the fiber type. Counts are binned in time
+/// (timeBins x timeBin, the last bin collects later photons); the gate
+/// [gateStart, gateEnd) is applied at end of event (gateEnd 0 = no gate), and
+/// with killLate tracks later than gateEnd are killed.
+
+class ReadoutParameters
+{
+  public:
+    enum class Sampling { Step, Event };
+
+    ReadoutParameters();
+    ~ReadoutParameters();
+
+    void SetSampling(G4String name);
+    Sampling GetSampling() const { return fSampling; }
+
+    void SetCerenkovBeta(G4String name);
+    G4bool GetCerenkovAverageBeta() const { return fCerenkovAverageBeta; }
+
+    // 光纤传输：衰减长度（0 为不衰减）、测量的透过率曲线（距离递增，空则用衰减长度）
+    struct TransmissionPoint {
+      G4double distance;
+      G4double transmission;
+    };
+    G4double GetAttenuationLength(FiberType type) const { return fAttenuationLength[G4int(type)]; }
+    const std::vector<TransmissionPoint>& GetTransmissionCurve(FiberType type) const {
+      return fTransmissionCurve[G4int(type)];
+    }
+    G4double GetMirrorReflectivity() const { return fMirrorReflectivity; }
+
+    // 到达时间：光纤群折射率、时间分格、积分门
+    G4double GetGroupIndex(FiberType type) const { return fGroupIndex[G4int(type)]; }
+    G4int GetTimeBins() const { return fTimeBins; }
+    G4double GetTimeBinWidth() const { return fTimeBinWidth; }
+    G4bool HasGate() const { return fGateEnd > 0.; }
+    G4double GetGateStart() const { return fGateStart; }
+    G4double GetGateEnd() const { return fGateEnd; }
+    // 径迹的全局时间超过此值时杀掉（不杀时为 DBL_MAX）
+    G4double GetKillTime() const { return (fKillLate && HasGate()) ? fGateEnd : DBL_MAX; }
+    // 基准测试：SteppingAction 统计步数（run 结束时打印 steps/s）
+    G4bool GetCountSteps() const { return fCountSteps; }
+
+    // 读取透过率曲线文件，"none" 清除
+    void LoadAttenuationFile(G4String fileName);
+
+  private:
+    void DefineCommands();
+    void BenchmarkSampler(G4int nSamples);
+
+    // step：每步泊松抽样；event：每步只累加平均光子数，事例结束时每个通道抽样一次
+    Sampling fSampling = Sampling::Step;
+    // 切伦科夫产额所用的动能：post（步末，径迹当前值）或 average（步首与步末平均）
+    G4bool fCerenkovAverageBeta = false;
+    // 按 FiberType 索引：闪烁光纤、石英光纤
+    G4double fAttenuationLength[2] = { 3.5*CLHEP::m, 10.*CLHEP::m };
+    std::vector<TransmissionPoint> fTransmissionCurve[2];
+    G4double fMirrorReflectivity = 0.;  // 前端镜面反射率
+    G4double fGroupIndex[2] = { 1.65, 1.48 };  // 聚苯乙烯、石英
+    G4int fTimeBins = 64;
+    G4double fTimeBinWidth = 4.*CLHEP::ns;
+    G4double fGateStart = 0.;
+    G4double fGateEnd = 0.;             // 0：不加积分门
+    G4bool fKillLate = false;
+    G4bool fCountSteps = false;
+    G4GenericMessenger* fMessenger = nullptr;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
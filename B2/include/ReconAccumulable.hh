@@ -0,0 +1,66 @@
+/// \file B2/include/ReconAccumulable.hh
+/// \brief Definition of the B2::ReconAccumulable class
+
+#ifndef B2ReconAccumulable_h
+#define B2ReconAccumulable_h 1
+#include "G4VAccumulable.hh"
+#include "G4Version.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+/// Streaming sums of the dual-readout reconstruction, one set per beam
+/// energy bin (the points of a /B2/scan, the bins of a /B2/spectrum, or a
+/// single bin).
+///
+/// Holds n, S, C, S^2, C^2, S*C, E_rec, E_rec^2, the beam energy and the
+/// response r = E_rec/E_beam, r^2 of each bin in one flat array. It is registered with G4AccumulableManager, so the
+/// worker copies are summed into the master at the end of the run like the
+/// scalar G4Accumulable values. All threads must call SetBins() with the same
+/// number of bins before the run starts.
+
+class ReconAccumulable : public G4VAccumulable
+{
+  public:
+    ReconAccumulable() : G4VAccumulable("Recon") {}
+    ~ReconAccumulable() override = default;
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+#if G4VERSION_NUMBER >= 1130
+    void Print(G4PrintOptions options = G4PrintOptions()) const override;
+#endif
+
+    // 设置分箱数并清零
+    void SetBins(G4int nBins);
+    G4int GetBins() const { return G4int(fSums.size()) / kNSums; }
+
+    void Fill(G4int bin, G4double s, G4double c, G4double e, G4double beam, G4double r);
+
+    G4double GetN(G4int bin) const { return Get(bin, kN); }
+    G4double GetSumS(G4int bin) const { return Get(bin, kS); }
+    G4double GetSumC(G4int bin) const { return Get(bin, kC); }
+    G4double GetSumS2(G4int bin) const { return Get(bin, kS2); }
+    G4double GetSumC2(G4int bin) const { return Get(bin, kC2); }
+    G4double GetSumSC(G4int bin) const { return Get(bin, kSC); }
+    G4double GetSumE(G4int bin) const { return Get(bin, kE); }
+    G4double GetSumE2(G4int bin) const { return Get(bin, kE2); }
+    G4double GetSumBeam(G4int bin) const { return Get(bin, kBeam); }
+    G4double GetSumR(G4int bin) const { return Get(bin, kR); }
+    G4double GetSumR2(G4int bin) const { return Get(bin, kR2); }
+
+  private:
+    enum Sum { kN, kS, kC, kS2, kC2, kSC, kE, kE2, kBeam, kR, kR2, kNSums };
+    G4double Get(G4int bin, Sum sum) const { return fSums[bin * kNSums + sum]; }
+
+    std::vector<G4double> fSums;   // 按分箱连续存放，每箱 kNSums 个和
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -5,42 +5,184 @@
 #define B2RunAction_h 1
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
+#include "G4Timer.hh"
 #include "globals.hh"
-#include "TTree.h"
-#include "TFile.h"
+#include "ReconAccumulable.hh"
+
+#include <memory>
+#include <vector>
 
 class G4Run;
+class G4Event;
+class G4GenericMessenger;
 
 namespace B2
 {
 
+class SteppingAction;
+class PrimaryGeneratorAction;
+class DetectorConstruction;
+class FiberHitsCollection;
+class ChannelMap;
+class Digitizer;
+class WaveformSynthesizer;
+class EventQueue;
+
 /// Run action class
 ///
 /// In EndOfRunAction(), it calculates the dose in the selected volume
 /// from the energy deposit accumulated via stepping and event actions.
 /// The computed dose is then printed on the screen.
+///
+/// PhotonTree holds one row per event: the S/C totals, the fired rods as
+/// zero-suppressed vector columns (channel ID = towerID*256 + i*16 + j, and
+/// photon count), the S/C sum of each tower as fixed scalar columns and, with
+/// /B2/digi/enable, the zero-suppressed ADC values of the Digitizer and,
+/// with /B2/digi/waveform, the waveform features of WaveformSynthesizer.
+///
+/// /B2/output/fileType selects where the rows go: root (G4AnalysisManager
+/// ntuple with merging, default), or raw / columnar (event records pushed to
+/// AsyncWriter and written by a separate thread to <fileName>.b2raw or to the
+/// column files in <fileName>.b2col, no ntuple merging; see OutputSink).
+/// The raw and columnar records carry the photon counts only, not the ADC
+/// values or waveform features; the master warns when /B2/digi is enabled
+/// with such an output.
+///
+/// Every event also feeds streaming S, C, S^2, C^2, S*C and E_rec accumulators,
+/// where E_rec = (S - chi*C)/(1 - chi) with S and C calibrated by the /B2/recon/
+/// photons-per-GeV constants (until both are set the run is uncalibrated: S, C
+/// and E_rec are then in photons and the master warns at the beginning of the
+/// run). At the
+/// end of the run the master prints mean, RMS, resolution and linearity and
+/// appends one line to the /B2/recon/summaryFile;
+/// during a /B2/scan or with a /B2/spectrum there is one set of accumulators,
+/// and one line, per energy bin, and the BeamEnergy and ScanPoint columns
+/// tag each event.
+///
+/// The same events fill per-thread histograms that are merged at the end of
+/// the run: H1 0-3 = S, C (calibrated, GeV), C/S and E_rec, H1 4-5 = S and C
+/// photon arrival time (before the gate), H2 0 = S vs C, H2 1 = E_rec/E_beam
+/// vs E_beam. Their ranges scale with the /gun/energy of the run (the highest
+/// scan or spectrum energy). Uncalibrated runs book S and C in photons, with
+/// the range scaled by a nominal light yield, and do not write H1 3 and H2 1.
+/// With
+/// /B2/output/perEvent false only the histograms are written.
 
 class RunAction : public G4UserRunAction
 {
   public:
+    enum class FileType { Root, Raw, Columnar };
+
     RunAction();
-    ~RunAction() override = default;
+    ~RunAction() override;
 
     void BeginOfRunAction(const G4Run*) override;
     void   EndOfRunAction(const G4Run*) override;
 
 
-    void FillPhotonTree(G4int scint, G4int cerenkov) {
-      fScintPhoton = scint;
-      fCerenkovPhoton = cerenkov;
-      fPhotonTree->Fill();
+    // 写一行 PhotonTree（由 EventAction 在事例结束时调用）
+    void FillPhotonTree(const G4Event* event, const FiberHitsCollection* scintHits,
+                        const FiberHitsCollection* cerenkovHits, const Digitizer* digitizer,
+                        const WaveformSynthesizer* waveforms);
+
+    void SetFileType(G4String name);
+
+    void AddSteps(G4long nSteps, G4long nFiberSteps) {
+      fNSteps += G4double(nSteps);
+      fNFiberSteps += G4double(nFiberSteps);
     }
 
+    void AddDigitizationTime(G4double seconds) { fDigitizationTime += seconds; }
+
+    void SetSteppingAction(SteppingAction* steppingAction) { fSteppingAction = steppingAction; }
+
+    // 直方图分箱所用的粒子产生器：工作线程用注册的那个，主线程接管一个不注册的副本
+    void SetPrimaryGenerator(const PrimaryGeneratorAction* generator) { fPrimaryGenerator = generator; }
+    void AdoptPrimaryGenerator(std::unique_ptr<PrimaryGeneratorAction> generator);
+
   private:
-    TFile* fFile;
-    TTree* fPhotonTree;
-    G4int fScintPhoton;
-    G4int fCerenkovPhoton;
+    // 把本事例的数据交给写线程（raw 输出）
+    void PushRecord(G4int eventID, G4int scintTotal, G4int cerenkovTotal, G4double energy);
+    void FillNtupleRow(G4int scintTotal, G4int cerenkovTotal);
+    void FillADC(const Digitizer* digitizer);
+    void FillWaveforms(const WaveformSynthesizer* waveforms);
+    void DefineCommands();
+
+    // 双读出能量重建：逐事例累加，run 结束时打印并写汇总文件
+    void SetScintCalib(G4double photonsPerGeV);
+    void SetCerenkovCalib(G4double photonsPerGeV);
+    G4bool IsCalibrated() const { return fScintCalibrated && fCerenkovCalibrated; }
+    void AccumulateRecon(G4int bin, G4int scintTotal, G4int cerenkovTotal, G4double beamEnergy);
+    void WriteReconSummary(const G4Run* run);
+
+    // 按本 run 的束流能量设置直方图范围（各线程相同，合并时分箱须一致）
+    void BookHistograms();
+    void FillHistograms(G4int scintTotal, G4int cerenkovTotal, G4double beamEnergy,
+                        const FiberHitsCollection* scintHits,
+                        const FiberHitsCollection* cerenkovHits);
+
+    // 零压缩：只写光子数非零的通道，并累加各 tower 的和
+    void FillChannels(const FiberHitsCollection* hits, const ChannelMap& channelMap,
+                      std::vector<G4int>& channels, std::vector<G4int>& counts,
+                      std::vector<G4int>& towerSums);
+
+    // PhotonTree 的列：0/1 总数，2-5 通道向量，之后为各 tower 的闪烁和、切伦科夫和，
+    // 向量列之后是束流能量与扫描点
+    const DetectorConstruction* fDetector = nullptr;
+    G4int fTowerColumn = 6;         // 第一个 tower 和的列号
+    G4int fEnergyColumn = 0;        // 束流能量的列号（扫描点在其后）
+    std::vector<G4int> fScintChannel;
+    std::vector<G4int> fScintCount;
+    std::vector<G4int> fCerenkovChannel;
+    std::vector<G4int> fCerenkovCount;
+    std::vector<G4int> fScintTower;
+    std::vector<G4int> fCerenkovTower;
+    // 数字化后零压缩的 ADC（铜棒号，ADC 值；未开启数字化时为空）
+    std::vector<G4int> fScintADCChannel;
+    std::vector<G4int> fScintADC;
+    std::vector<G4int> fCerenkovADCChannel;
+    std::vector<G4int> fCerenkovADC;
+    // 波形特征量（通道 = 类型*铜棒数 + 铜棒号；未开启波形模式时为空）
+    std::vector<G4int> fWaveChannel;
+    std::vector<G4double> fWaveAmplitude;
+    std::vector<G4double> fWaveIntegral;
+    std::vector<G4double> fWavePeakTime;
+    std::vector<G4double> fWaveTimeOverThreshold;
+    std::vector<G4float> fWaveform;   // 仅 /B2/digi/writeWaveforms
+
+    // 异步输出
+    FileType fFileType = FileType::Root;
+    G4bool fPerEvent = true;           // false：只写直方图，不写逐事例输出
+    G4int fHistBins = 100;             // 一维直方图（及二维每个方向）的分箱数
+    G4int fQueueSize = 1024;           // 每个工作线程队列的记录数
+    EventQueue* fQueue = nullptr;      // 本线程的队列（第一次 raw 输出时创建，容量由主线程调整）
+    G4GenericMessenger* fMessenger = nullptr;
+
+    SteppingAction* fSteppingAction = nullptr; // 工作线程：每个run开始时重建体积分类表
+    const PrimaryGeneratorAction* fPrimaryGenerator = nullptr;
+    std::unique_ptr<PrimaryGeneratorAction> fMasterGenerator;
+
+    // 步进速率统计：各线程步数合并后，在主线程用墙钟时间换算成 steps/s
+    G4Accumulable<G4double> fNSteps = 0.;
+    G4Accumulable<G4double> fNFiberSteps = 0.;
+    G4Accumulable<G4double> fOutputTime = 0.;  // 事例循环中输出的耗时（各线程之和）
+    G4Accumulable<G4double> fDigitizationTime = 0.;
+
+    // 能量重建参数（/B2/recon/）
+    G4double fScintCalib = 1.;     // 闪烁光子数/GeV
+    G4double fCerenkovCalib = 1.;  // 切伦科夫光子数/GeV
+    G4bool fScintCalibrated = false;    // 由 /B2/recon/scintCalib 设定
+    // 未标定时按此光产额（光子数/GeV）设定 S、C 直方图范围
+    static constexpr G4double kNominalScintPerGeV = 1.e5;
+    static constexpr G4double kNominalCerenkovPerGeV = 1.e3;
+    G4bool fCerenkovCalibrated = false; // 由 /B2/recon/cerenkovCalib 设定
+    G4double fChi = 0.3;           // E = (S - chi*C)/(1 - chi)
+    G4String fSummaryFile = "recon_summary.txt";
+    G4GenericMessenger* fReconMessenger = nullptr;
+
+    // 能量重建的流式累加量（光子数，E 与束流能量单位为 GeV），每个能量分箱一组
+    ReconAccumulable fRecon;
+    G4Timer fTimer;
 };
 
 }
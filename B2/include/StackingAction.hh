@@ -0,0 +1,40 @@
+/// \file B2/include/StackingAction.hh
+/// \brief Definition of the B2::StackingAction class
+
+#ifndef B2StackingAction_h
+#define B2StackingAction_h 1
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+namespace B2
+{
+
+class DetectorConstruction;
+
+/// Stacking action class
+///
+/// With /B2/readout/killLate, new tracks created after the end of the
+/// integration gate are killed before they are tracked: their light could
+/// only arrive later still. Mostly neutron captures and their gammas. Tracks
+/// that cross the gate end while being tracked are stopped by the G4UserLimits
+/// time limit (DetectorConstruction::UpdateTimeLimit, G4UserSpecialCuts).
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction() = default;
+    ~StackingAction() override = default;
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+    void PrepareNewEvent() override;
+
+  private:
+    const DetectorConstruction* fDetector = nullptr;
+    G4double fKillTime = DBL_MAX;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -5,7 +5,9 @@
 #define B2SteppingAction_h 1
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
-#include "CLHEP/Units/SystemOfUnits.h" // 单位头文件CLHEP
+#include "FiberResponse.hh"
+
+#include <vector>
 
 class G4LogicalVolume;
 
@@ -13,8 +15,18 @@ namespace B2
 {
 
 class EventAction;
+class DetectorConstruction;
 
 /// Stepping action class
+///
+/// The volume of each step is classified through a flat table indexed by the
+/// logical-volume instance ID (scintillating fiber, Cerenkov fiber or passive),
+/// built once per run by BuildVolumeTable(), so that passive steps return
+/// after a single lookup. With the sd readout it is only registered to count
+/// steps, and every volume is passive (FiberSD handles the fibers).
+/// /B2/readout/killLate is not applied here but by StackingAction and the
+/// G4UserLimits time limit of DetectorConstruction.
+/// Steps are only counted with /B2/readout/countSteps (benchmarks).
 
 class SteppingAction : public G4UserSteppingAction
 {
@@ -25,14 +37,17 @@ class SteppingAction : public G4UserSteppingAction
     // method from the base class
     void UserSteppingAction(const G4Step*) override;
 
+    // 体积分类表（及光子产额表的重置），由 RunAction::BeginOfRunAction 调用
+    void BuildVolumeTable();
+
   private:
+    enum VolumeKind : G4int { kPassive = 0, kScint, kCerenkov };
+
     EventAction* fEventAction = nullptr;
-  
-    // 固定参数
-    const G4double fCollectionEfficiency = 0.9; // 光子收集效率
-    const G4double fScintillationYield = 10000.0 / CLHEP::MeV; // 闪烁产额
-    const G4double fRefIndex = 1.458; // 切伦科夫效应折射率
-    const G4double fBetaThreshold = 1.0 / fRefIndex; // 切伦科夫阈值β
+    std::vector<G4int> fVolumeKind; // 按逻辑体 instance ID 索引
+    const DetectorConstruction* fDetector = nullptr;
+    FiberResponse fResponse;        // 光子产额（与 FiberSD 共用）
+    G4bool fCountSteps = false;     // 步数统计（/B2/readout/countSteps）
 };
 
 }
@@ -0,0 +1,49 @@
+/// \file B2/include/WorkerInitialization.hh
+/// \brief Definition of the B2::WorkerInitialization class
+
+#ifndef B2WorkerInitialization_h
+#define B2WorkerInitialization_h 1
+#include "G4UserWorkerInitialization.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+/// Worker thread initialization: pins each worker thread to CPUs according
+/// to the policy given on the command line (-a):
+/// - none:    no pinning (default)
+/// - compact: worker i on the i-th allowed CPU, filling one NUMA node first
+/// - scatter: one CPU per worker, alternating between the NUMA nodes
+/// - numa:    worker i on all CPUs of node i % nNodes (the kernel still
+///            balances within the socket, but the thread never crosses it)
+/// The NUMA layout is read from /sys/devices/system/node; only the CPUs in
+/// the process affinity mask are used. Linux only, elsewhere a warning.
+
+class WorkerInitialization : public G4UserWorkerInitialization
+{
+  public:
+    enum class Affinity { None, Compact, Scatter, Numa };
+
+    WorkerInitialization(Affinity affinity);
+    ~WorkerInitialization() override = default;
+
+    void WorkerStart() const override;
+
+    // 命令行参数 -> 策略，未知名称返回 false
+    static G4bool ParseAffinity(const G4String& name, Affinity& affinity);
+
+  private:
+    // 各 NUMA 节点上允许使用的逻辑 CPU
+    void ReadTopology();
+
+    Affinity fAffinity = Affinity::None;
+    std::vector<std::vector<G4int>> fNodes;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
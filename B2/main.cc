@@ -3,12 +3,16 @@
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "WorkerInitialization.hh"
+#include "BalancedRunManager.hh"
 
 #include "G4RunManagerFactory.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UImanager.hh"
+#include "G4UIcommand.hh"
 // #include "QBBC.hh"
 #include "FTFP_BERT.hh"
+#include "G4StepLimiterPhysics.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
@@ -17,14 +21,61 @@
 
 using namespace B2;
 
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " B2 [macro] [-m macro] [-r default|mt|tasking|serial] [-t nThreads]" << G4endl;
+    G4cerr << "    [-a none|compact|scatter|numa] [-e eventModulo] [-b fixed|adaptive]" << G4endl;
+    G4cerr << "   -r  run manager type (default: G4RunManagerFactory default, i.e. $G4RUN_MANAGER_TYPE or MT/tasking)" << G4endl;
+    G4cerr << "   -t  number of worker threads (MT/tasking only)" << G4endl;
+    G4cerr << "   -a  CPU pinning of the worker threads (MT/tasking only, see WorkerInitialization)" << G4endl;
+    G4cerr << "   -e  events per chunk handed to a worker, 0 = Geant4 default (MT/tasking only)" << G4endl;
+    G4cerr << "   -b  event chunks: fixed eventModulo, or adaptive sizes from the expected event cost" << G4endl;
+    G4cerr << "       (MT only: -r mt, or -r default when the default type is MT)" << G4endl;
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // Evaluate arguments: a single argument without "-" is the macro (as before)
+  //
+  G4String macro;
+  G4String runManagerName = "default";
+  G4int nThreads = 0;
+  G4int eventModulo = -1;
+  G4String balance = "fixed";
+  WorkerInitialization::Affinity affinity = WorkerInitialization::Affinity::None;
+  for ( G4int i=1; i<argc; i=i+2 ) {
+    G4String option = argv[i];
+    if ( option[0] != '-' ) { macro = option; i--; continue; }
+    if ( i+1 >= argc ) { PrintUsage(); return 1; }
+    if      ( option == "-m" ) macro = argv[i+1];
+    else if ( option == "-r" ) runManagerName = argv[i+1];
+    else if ( option == "-t" ) nThreads = G4UIcommand::ConvertToInt(argv[i+1]);
+    else if ( option == "-e" ) eventModulo = G4UIcommand::ConvertToInt(argv[i+1]);
+    else if ( option == "-b" ) balance = argv[i+1];
+    else if ( option == "-a" ) {
+      if ( ! WorkerInitialization::ParseAffinity(argv[i+1], affinity) ) { PrintUsage(); return 1; }
+    }
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  G4RunManagerType runManagerType = G4RunManagerType::Default;
+  if      ( runManagerName == "mt" ) runManagerType = G4RunManagerType::MT;
+  else if ( runManagerName == "tasking" ) runManagerType = G4RunManagerType::Tasking;
+  else if ( runManagerName == "serial" ) runManagerType = G4RunManagerType::Serial;
+  else if ( runManagerName != "default" ) { PrintUsage(); return 1; }
+  if ( balance != "fixed" && balance != "adaptive" ) { PrintUsage(); return 1; }
+
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive* ui = nullptr;
-  if ( argc == 1 ) { ui = new G4UIExecutive(argc, argv); }
+  if ( macro.empty() ) { ui = new G4UIExecutive(argc, argv); }
 
   // Optionally: choose a different Random engine...
   // G4Random::setTheEngine(new CLHEP::MTwistEngine);
@@ -33,11 +84,37 @@ int main(int argc,char** argv)
   G4int precision = 4;
   G4SteppingVerbose::UseBestUnit(precision);
 
-  // Construct the default run manager
+  // Construct the run manager (-r; serial 为单线程，便于交互调试)
   //
-  auto runManager =
-    G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default); //默认类型 批处理
-    // G4RunManagerFactory::CreateRunManager(G4RunManagerType::Serial); //单线程 交互模式
+  // 自适应分块只能替换 MT 的分发（tasking 在 run 开始时就把事例切成任务）；
+  // -r default 按工厂的默认类型（$G4RUN_MANAGER_TYPE 或编译时的默认值）判断
+  G4RunManager* runManager = nullptr;
+  G4bool adaptive = balance == "adaptive";
+  G4RunManagerType resolvedType = runManagerType;
+  if ( resolvedType == G4RunManagerType::Default ) {
+    resolvedType = G4RunManagerFactory::GetType(G4RunManagerFactory::GetDefault());
+  }
+  if ( adaptive && resolvedType == G4RunManagerType::MT ) {
+    runManager = new BalancedRunManager;
+  }
+  else {
+    if ( adaptive ) {
+      G4cerr << "Adaptive event chunks need the MT run manager, but -r " << runManagerName
+             << " resolves to " << G4RunManagerFactory::GetName(resolvedType)
+             << ": -b is ignored (use -r mt)." << G4endl;
+      adaptive = false;
+    }
+    runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
+  }
+  // 多线程（MT/tasking）才有工作线程：线程数、CPU 绑定与每次分发的事例数
+  G4bool multiThreaded = runManager->GetRunManagerType() != G4RunManager::sequentialRM;
+  if ( multiThreaded ) {
+    if ( nThreads > 0 ) runManager->SetNumberOfThreads(nThreads);
+    runManager->SetUserInitialization(new WorkerInitialization(affinity));
+  }
+  else if ( nThreads > 0 || eventModulo >= 0 || affinity != WorkerInitialization::Affinity::None ) {
+    G4cerr << "Serial run manager: -t, -a and -e are ignored." << G4endl;
+  }
 
   // Set mandatory initialization classes
   //
@@ -47,6 +124,8 @@ int main(int argc,char** argv)
   // Physics list
   auto physicsList = new FTFP_BERT;
   physicsList->SetVerboseLevel(0);  //详细程度0
+  // G4UserSpecialCuts：按 G4UserLimits 的时间上限停止积分门之后的径迹（/B2/readout/killLate）
+  physicsList->RegisterPhysics(new G4StepLimiterPhysics());
   runManager->SetUserInitialization(physicsList);
 
   // User action initialization
@@ -64,13 +143,20 @@ int main(int argc,char** argv)
   // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
 
+  // 每个工作线程一次领取的事例数（宏文件中的 /run/eventModulo 可再覆盖）
+  if ( adaptive && eventModulo >= 0 ) {
+    G4cerr << "Adaptive event chunks: -e is ignored." << G4endl;
+  }
+  else if ( multiThreaded && eventModulo >= 0 ) {
+    UImanager->ApplyCommand("/run/eventModulo " + std::to_string(eventModulo));
+  }
+
   // Process macro or start UI session
   //
   if ( ! ui ) {
     // batch mode
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
   }
   else {
     // interactive mode
@@ -8,6 +8,10 @@
 #include "RunAction.hh"
 #include "EventAction.hh"
 #include "SteppingAction.hh"
+#include "StackingAction.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4RunManager.hh"
 
 namespace B2
 {
@@ -17,6 +21,9 @@ namespace B2
 void ActionInitialization::BuildForMaster() const
 {
   auto runAction = new RunAction;
+  // 主线程不产生事例，但直方图分箱要用 /gun/energy（须与工作线程一致才能合并）：
+  // 建一个不注册的粒子产生器接收主线程上的 /gun/ 命令
+  runAction->AdoptPrimaryGenerator(std::make_unique<PrimaryGeneratorAction>());
   SetUserAction(runAction);
 }
 
@@ -25,18 +32,34 @@ void ActionInitialization::BuildForMaster() const
 void ActionInitialization::Build() const
 {
   // 1. 创建粒子产生器动作并注册
-  SetUserAction(new PrimaryGeneratorAction);
+  auto primaryGenerator = new PrimaryGeneratorAction;
+  SetUserAction(primaryGenerator);
 
   // 2. 创建运行动作并注册（用于数据文件初始化、统计汇总）
   auto runAction = new RunAction;
+  runAction->SetPrimaryGenerator(primaryGenerator);
   SetUserAction(runAction);
 
   // 3. 创建事例动作并注册（用于单个事例的信号累加）
   auto eventAction = new EventAction(runAction);
   SetUserAction(eventAction);
 
-  // 4. 创建步进动作并注册（用于每一步的处理，如能量沉积记录）
-  SetUserAction(new SteppingAction(eventAction));
+  // 4. 堆栈动作：积分门之后产生的径迹直接杀掉（/B2/readout/killLate；飞行中的径迹见 DetectorConstruction::UpdateTimeLimit）
+  SetUserAction(new StackingAction);
+
+  // 5. 创建步进动作并注册（用于每一步的处理，如能量沉积记录）
+  //    sd 读出时由 FiberSD 处理光纤内的步，只在统计步数（/B2/readout/countSteps）时注册
+  //    （串行模式下 Build() 在宏命令之前调用，此时仍会注册，但所有体积都被归为非光纤）；
+  //    killLate 由堆栈动作与 G4UserLimits 的时间上限完成，不需要步进动作
+  auto detConst = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if (detConst->GetReadout() == DetectorConstruction::Readout::SD
+      && !detConst->GetReadoutParameters().GetCountSteps()) {
+    return;
+  }
+  auto steppingAction = new SteppingAction(eventAction);
+  SetUserAction(steppingAction);
+  runAction->SetSteppingAction(steppingAction);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,188 @@
+/// \file B2/src/AsyncWriter.cc
+/// \brief Implementation of the B2::AsyncWriter class
+
+// AsyncWriter.cc：工作线程 -> 无锁队列 -> 写线程 -> 文件
+#include "AsyncWriter.hh"
+
+#include "G4Timer.hh"
+
+#include <algorithm>
+#include <chrono>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AsyncWriter& AsyncWriter::Instance()
+{
+  static AsyncWriter instance;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AsyncWriter::~AsyncWriter()
+{
+  Stop();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool AsyncWriter::Start(std::unique_ptr<OutputSink> sink, const G4String& fileName, G4int nTowers,
+                          std::size_t capacity)
+{
+  Stop();
+
+  if (!sink->Open(fileName, nTowers)) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open output file " << fileName << "." << G4endl
+        << "Check the output directory, or use /B2/output/fileType root.";
+    G4Exception("AsyncWriter::Start()", "B2Output001", FatalException, msg);
+    return false;
+  }
+  fSink = std::move(sink);
+
+  fRecords = 0;
+  fDepthSamples = 0;
+  fDepthSum = 0.;
+  fMaxDepth = 0;
+  {
+    // 上一个 run 的写线程已排空所有队列、工作线程尚未开始，可以安全地改变容量
+    std::lock_guard<std::mutex> lock(fMutex);
+    fCapacity = capacity;
+    for (auto& queue : fQueues) {
+      queue->Resize(capacity);
+      queue->fStalls = 0;
+      queue->fStallTime = 0.;
+    }
+  }
+
+  fStop = false;
+  fThread = std::thread(&AsyncWriter::Run, this);
+  fActive.store(true, std::memory_order_release);
+  G4cout << "### Async writer: writing " << fileName << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AsyncWriter::Stop()
+{
+  if (!fThread.joinable()) {
+    return;
+  }
+  fActive.store(false, std::memory_order_release);
+  G4Timer timer;
+  timer.Start();
+  fStop.store(true, std::memory_order_release);
+  fThread.join();
+  fSink->Close();
+  timer.Stop();
+
+  G4long stalls = 0;
+  G4double stallTime = 0.;
+  std::size_t capacity = 0;
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (auto& queue : fQueues) {
+      stalls += queue->fStalls;
+      stallTime += queue->fStallTime;
+      capacity = queue->Capacity();
+    }
+  }
+
+  G4cout << "### Async writer: " << fRecords << " events, "
+         << fSink->GetBytesWritten() / (1024.*1024.) << " MB, "
+         << timer.GetRealElapsed() << " s to drain after the event loop" << G4endl
+         << "    queue depth mean " << (fDepthSamples > 0 ? fDepthSum / fDepthSamples : 0.)
+         << ", max " << fMaxDepth << " (capacity " << capacity << " per thread)"
+         << ", producer stalls " << stalls << " (" << stallTime << " s)" << G4endl;
+  fSink.reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventQueue* AsyncWriter::AttachProducer()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fQueues.push_back(std::make_unique<EventQueue>(fCapacity));
+  return fQueues.back().get();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventRecord* AsyncWriter::Claim(EventQueue* queue)
+{
+  EventRecord* slot = queue->Claim();
+  if (slot) {
+    return slot;
+  }
+
+  // 背压：队列满时等待写线程腾出槽位
+  auto start = std::chrono::steady_clock::now();
+  while (!(slot = queue->Claim())) {
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  std::chrono::duration<G4double> waited = std::chrono::steady_clock::now() - start;
+  queue->fStalls.store(queue->fStalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  queue->fStallTime.store(queue->fStallTime.load(std::memory_order_relaxed) + waited.count(),
+                          std::memory_order_relaxed);
+  return slot;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AsyncWriter::Run()
+{
+  std::vector<EventQueue*> queues;
+  while (true) {
+    // 先读停止标志再排空：停止后一轮排空为0即说明所有记录都已写出
+    G4bool stop = fStop.load(std::memory_order_acquire);
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      queues.clear();
+      for (auto& queue : fQueues) {
+        queues.push_back(queue.get());
+      }
+    }
+    if (Drain(queues) == 0) {
+      if (stop) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t AsyncWriter::Drain(const std::vector<EventQueue*>& queues)
+{
+  std::size_t depth = 0;
+  for (auto queue : queues) {
+    depth += queue->Size();
+  }
+  fDepthSum += depth;
+  ++fDepthSamples;
+  fMaxDepth = std::max(fMaxDepth, depth);
+
+  std::size_t nWritten = 0;
+  for (auto queue : queues) {
+    for (std::size_t i = 0; i < kBatch; i++) {
+      EventRecord* record = queue->Peek();
+      if (!record) {
+        break;
+      }
+      fSink->Write(*record);
+      queue->Release();
+      ++nWritten;
+    }
+  }
+  fRecords += nWritten;
+  return nWritten;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,36 @@
+/// \file B2/src/BalancedRunManager.cc
+/// \brief Implementation of the B2::BalancedRunManager class
+
+// BalancedRunManager.cc：工作线程每次取事例时按预计代价决定取多少个
+#include "BalancedRunManager.hh"
+#include "LoadBalancer.hh"
+
+#include "G4AutoLock.hh"
+
+namespace B2
+{
+
+namespace
+{
+  G4Mutex chunkMutex = G4MUTEX_INITIALIZER;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int BalancedRunManager::SetUpNEvents(G4Event* event, G4SeedsQueue* seedsQueue,
+                                       G4bool reseedRequired)
+{
+  // eventModulo 与已分发事例数要在同一把锁下读写，否则两个线程会用同一个块大小
+  G4AutoLock lock(&chunkMutex);
+  G4int first = numberOfEventProcessed;
+  G4int remaining = numberOfEventToBeProcessed - first;
+  if (remaining > 0) {
+    eventModulo = LoadBalancer::Instance().ChunkSize(first, remaining, GetNumberOfThreads());
+  }
+  // 随机数种子按事例分配（默认 /run/seedOncePerCommunication 0），结果与块大小无关
+  return G4MTRunManager::SetUpNEvents(event, seedsQueue, reseedRequired);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,92 @@
+/// \file B2/src/ChannelMap.cc
+/// \brief Implementation of the B2::ChannelMap class
+
+// ChannelMap.cc：铜棒/光纤通道的编码与查表解码
+#include "ChannelMap.hh"
+
+#include "G4VTouchable.hh"
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ChannelMap::Build(const ChannelGeometry& geometry)
+{
+  fGeometry = geometry;
+  const G4int n = geometry.rodPerTower;
+  const G4int nTowerSide = geometry.towerPerSide;
+  fRodsPerTower = n*n;
+  fFibersPerRod = geometry.nScintFiber + geometry.nCerenkovFiber;
+  fLatticeSide = n*nTowerSide;
+
+  // 1. tower 编号 -> 该 tower 第一根铜棒的编号（tower 号 = 行*每边tower数 + 列）
+  G4int nTowers = nTowerSide*nTowerSide;
+  fTowerBase.resize(nTowers);
+  for (G4int tower = 0; tower < nTowers; tower++) {
+    fTowerBase[tower] = tower*fRodsPerTower;
+  }
+
+  // 2. 点阵全局列号/行号 -> 铜棒编号
+  fLatticeRod.assign(fLatticeSide*fLatticeSide, 0);
+  for (G4int iGlobal = 0; iGlobal < fLatticeSide; iGlobal++) {
+    for (G4int jGlobal = 0; jGlobal < fLatticeSide; jGlobal++) {
+      G4int tower = (jGlobal / n)*nTowerSide + iGlobal / n;
+      fLatticeRod[iGlobal*fLatticeSide + jGlobal] = EncodeRod(tower, iGlobal % n, jGlobal % n);
+    }
+  }
+
+  // 3. 解码表
+  G4int nRods = nTowers*fRodsPerTower;
+  fRodTower.resize(nRods);
+  fRodI.resize(nRods);
+  fRodJ.resize(nRods);
+  for (G4int tower = 0; tower < nTowers; tower++) {
+    for (G4int i = 0; i < n; i++) {
+      for (G4int j = 0; j < n; j++) {
+        G4int rod = EncodeRod(tower, i, j);
+        fRodTower[rod] = tower;
+        fRodI[rod] = i;
+        fRodJ[rod] = j;
+      }
+    }
+  }
+
+  fChannelRod.resize(nRods*fFibersPerRod);
+  fChannelSlot.resize(nRods*fFibersPerRod);
+  for (G4int channel = 0; channel < nRods*fFibersPerRod; channel++) {
+    fChannelRod[channel] = channel / fFibersPerRod;
+    fChannelSlot[channel] = channel % fFibersPerRod;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int ChannelMap::GetRodID(const G4VTouchable* touchable) const
+{
+  const G4int rodDepth = fGeometry.rodDepth;
+  switch (fGeometry.addressing) {
+    case ChannelGeometry::Addressing::Copy:
+      return touchable->GetCopyNumber(rodDepth);
+
+    case ChannelGeometry::Addressing::TowerCopy:
+      return fTowerBase[touchable->GetCopyNumber(rodDepth + 1)] + touchable->GetCopyNumber(rodDepth);
+
+    case ChannelGeometry::Addressing::Lattice:
+      return fLatticeRod[touchable->GetReplicaNumber(rodDepth + 2)*fLatticeSide
+                         + touchable->GetReplicaNumber(rodDepth + 1)];
+
+    case ChannelGeometry::Addressing::Replica: {
+      G4int towerX = touchable->GetReplicaNumber(fGeometry.towerDepth);
+      G4int towerY = touchable->GetReplicaNumber(fGeometry.towerDepth + 1);
+      return fTowerBase[towerY*fGeometry.towerPerSide + towerX]
+             + touchable->GetReplicaNumber(rodDepth + 2)*fGeometry.rodPerTower
+             + touchable->GetReplicaNumber(rodDepth + 1);
+    }
+  }
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
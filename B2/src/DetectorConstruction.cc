@@ -2,6 +2,8 @@
 /// \brief Implementation of the B2::DetectorConstruction class
 
 #include "DetectorConstruction.hh"
+#include "LatticeValidator.hh"
+#include "FiberSD.hh"
 
 #include "G4RunManager.hh"
 #include "G4NistManager.hh"
@@ -13,6 +15,14 @@
 #include "G4Trd.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4UserLimits.hh"
+#include "G4VTouchable.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SDManager.hh"
+#include "G4Timer.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4RotationMatrix.hh"
 #include "G4ThreeVector.hh"
@@ -22,6 +32,9 @@
 #include "G4TransportationManager.hh"
 #include "G4SystemOfUnits.hh" 
 #include "G4SubtractionSolid.hh" // 用于布尔减运算
+#include "G4MultiUnion.hh"
+
+#include <cmath>
 
 namespace B2
 {
@@ -45,6 +58,22 @@ const G4double Tower_spacing = 64.04 * mm; // tower间距
 // const G4double CuRod_spacing = 4.1 * mm;  // 铜棒间距
 // const G4double Tower_spacing = 66* mm; // tower间距
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorConstruction::DetectorConstruction()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorConstruction::~DetectorConstruction()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 // 封装：创建单根铜棒逻辑体（铜棒+光纤逻辑）
 G4LogicalVolume* DetectorConstruction::CreateSingleCuRodLogical(G4NistManager *nist)
 {
@@ -67,39 +96,65 @@ G4LogicalVolume* DetectorConstruction::CreateSingleCuRodLogical(G4NistManager *n
   //     0,                  // 旋转矩阵（无旋转）
   //     G4ThreeVector(0,0,0) // 位置（中心对齐）
   //   );
-  G4LogicalVolume* logicHole = new G4LogicalVolume(solidHole, Air, "LogicHole");
-  new G4PVPlacement(0, G4ThreeVector(0,0,0), logicHole, "PhysHole", logicCuRod, false, 0);
 
+  // 光纤在孔内的位置
   const G4double rt3_2 = 0.866025 * Fiber_d;
-  // 4. 闪烁光纤
+  const G4ThreeVector scintPos[nScintFiber] = {
+    G4ThreeVector(0, 0.8*mm, 0),        // 闪烁光纤1：顶部（对应图中上方蓝色S）
+    G4ThreeVector(-rt3_2, -0.4*mm, 0),  // 闪烁光纤2：底部左侧（对应图中下方左蓝色）
+    G4ThreeVector(rt3_2, -0.4*mm, 0)    // 闪烁光纤3：底部右侧（对应图中下方右蓝色）
+  };
+  const G4ThreeVector cerenkovPos[nCerenkovFiber] = {
+    G4ThreeVector(-rt3_2, 0.4*mm, 0),   // 光纤0：左侧上方
+    G4ThreeVector(rt3_2, 0.4*mm, 0),    // 光纤1：右侧上方
+    G4ThreeVector(0*mm, 0*mm, 0),       // 光纤2：中心
+    G4ThreeVector(0*mm, -0.8*mm, 0)     // 光纤3：右侧最右方（下方）
+  };
+
+  fFiberPositions.assign(std::begin(scintPos), std::end(scintPos));
+  fFiberPositions.insert(fFiberPositions.end(), std::begin(cerenkovPos), std::end(cerenkovPos));
+
   G4Tubs* solidScintFiber = new G4Tubs("ScintFiber", 0, Fiber_d/2, CuRod_length/2, 0, 360*deg);
+  G4Tubs* solidCerenkovFiber = new G4Tubs("CerenkovFiber", 0, Fiber_d/2, CuRod_length/2, 0, 360*deg);
+
+  // nested：铜棒 -> 空气孔 -> 7根光纤（三层）
+  // flat：  铜棒 -> {空气孔（孔减去7根光纤的布尔体）, 7根光纤}（两层，光纤直接是铜棒的子体积）
+  G4LogicalVolume* fiberMother = nullptr;
+  if (fRodModel == RodModel::Flat) {
+    auto solidFiberBundle = new G4MultiUnion("FiberBundle");
+    for (const auto& pos : scintPos) {
+      solidFiberBundle->AddNode(*solidScintFiber, G4Transform3D(G4RotationMatrix(), pos));
+    }
+    for (const auto& pos : cerenkovPos) {
+      solidFiberBundle->AddNode(*solidCerenkovFiber, G4Transform3D(G4RotationMatrix(), pos));
+    }
+    solidFiberBundle->Voxelize();
+
+    auto solidHoleAir = new G4SubtractionSolid("HoleAir", solidHole, solidFiberBundle);
+    G4LogicalVolume* logicHole = new G4LogicalVolume(solidHoleAir, Air, "LogicHole");
+    new G4PVPlacement(0, G4ThreeVector(0,0,0), logicHole, "PhysHole", logicCuRod, false, 0);
+    fiberMother = logicCuRod;
+  }
+  else {
+    G4LogicalVolume* logicHole = new G4LogicalVolume(solidHole, Air, "LogicHole");
+    new G4PVPlacement(0, G4ThreeVector(0,0,0), logicHole, "PhysHole", logicCuRod, false, 0);
+    fiberMother = logicHole;
+  }
+
+  // 4. 闪烁光纤
   G4LogicalVolume* logicScintFiber = new G4LogicalVolume(solidScintFiber, ScintFiber, "LogicScintFiber");
-  // 闪烁光纤1：顶部（对应图中上方蓝色S）
-  new G4PVPlacement(0, G4ThreeVector(0, 0.8*mm, 0), 
-                  logicScintFiber, "PhysScintFiber_0", logicHole, false, 0);
-  // 闪烁光纤2：底部左侧（对应图中下方左蓝色）
-  new G4PVPlacement(0, G4ThreeVector(-rt3_2, -0.4*mm, 0), 
-                  logicScintFiber, "PhysScintFiber_1", logicHole, false, 1);
-  // 闪烁光纤3：底部右侧（对应图中下方右蓝色）
-  new G4PVPlacement(0, G4ThreeVector(rt3_2, -0.4*mm, 0), 
-                  logicScintFiber, "PhysScintFiber_2", logicHole, false, 2);
+  for (G4int k = 0; k < nScintFiber; k++) {
+    new G4PVPlacement(0, scintPos[k], logicScintFiber, "PhysScintFiber_" + std::to_string(k),
+                      fiberMother, false, k);
+  }
   fScoringVolume = logicScintFiber;
 
   // 5. 切伦科夫光纤
-  G4Tubs* solidCerenkovFiber = new G4Tubs("CerenkovFiber", 0, Fiber_d/2, CuRod_length/2, 0, 360*deg);
   G4LogicalVolume* logicCerenkovFiber = new G4LogicalVolume(solidCerenkovFiber, CerenkovFiber, "LogicCerenkovFiber");
-  // 光纤0：左侧上方
-  new G4PVPlacement(0, G4ThreeVector(-rt3_2, 0.4*mm, 0), 
-                    logicCerenkovFiber, "PhysCerenkovFiber_0", logicHole, false, 0);
-  // 光纤1：右侧上方
-  new G4PVPlacement(0, G4ThreeVector(rt3_2, 0.4*mm, 0), 
-                    logicCerenkovFiber, "PhysCerenkovFiber_1", logicHole, false, 1);
-  // 光纤2：中心
-  new G4PVPlacement(0, G4ThreeVector(0*mm, 0*mm, 0), 
-                    logicCerenkovFiber, "PhysCerenkovFiber_2", logicHole, false, 2);
-  // 光纤3：右侧最右方（下方）
-  new G4PVPlacement(0, G4ThreeVector(0*mm, -0.8*mm, 0), 
-                    logicCerenkovFiber, "PhysCerenkovFiber_3", logicHole, false, 3);
+  for (G4int k = 0; k < nCerenkovFiber; k++) {
+    new G4PVPlacement(0, cerenkovPos[k], logicCerenkovFiber, "PhysCerenkovFiber_" + std::to_string(k),
+                      fiberMother, false, k);
+  }
   fScoringVolumeCerenkov = logicCerenkovFiber;
 
   return logicCuRod;
@@ -119,7 +174,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   G4Box* solidWorld = new G4Box("World", world_xy/2, world_xy/2, world_z/2);
   G4LogicalVolume* logicWorld = new G4LogicalVolume(solidWorld, worldMat, "LogicWorld");
   G4VPhysicalVolume* physWorld = new G4PVPlacement(0, G4ThreeVector(0,0,0), logicWorld, "PhysWorld",
-                                                   0, false, 0, true);
+                                                   0, false, 0, fCheckOverlaps);
 
   // 2.单根铜棒逻辑体（复用封装函数）
   G4LogicalVolume* logicSingleCuRod = CreateSingleCuRodLogical(nist);
@@ -130,6 +185,144 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   detRot->rotateX(0.7*deg);
 
   // 4. Tower 和 CopperRod 放置
+  G4Timer timer;
+  timer.Start();
+  if (fLayout == Layout::Lattice
+      && std::abs(Tower_spacing - RodPerTower * CuRod_spacing) > 1.0e-9 * mm) {
+    G4ExceptionDescription msg;
+    msg << "Tower_spacing (" << Tower_spacing/mm << " mm) is not RodPerTower*CuRod_spacing ("
+        << RodPerTower * CuRod_spacing/mm << " mm): the rod matrix is not a single regular lattice."
+        << G4endl << "Falling back to the replica layout.";
+    G4Exception("DetectorConstruction::Construct()", "B2Geom001", JustWarning, msg);
+    fLayout = Layout::Replica;
+  }
+
+  if (fLayout != Layout::Placement) {
+    // 整个量能器一起旋转，内部为轴对齐的复制体层级
+    G4LogicalVolume* logicCalorimeter = (fLayout == Layout::Lattice)
+      ? BuildLatticeCalorimeter(logicSingleCuRod, worldMat)
+      : BuildReplicaCalorimeter(logicSingleCuRod, worldMat);
+    new G4PVPlacement(detRot, G4ThreeVector(0,0,0), logicCalorimeter, "PhysCalorimeter",
+                      logicWorld, false, 0, fCheckOverlaps);
+  }
+  else if (fEnvelope != Envelope::None) {
+    // 逐根放置，但放在整体旋转的量能器包络体内，铜棒本身不再旋转
+    G4LogicalVolume* logicCalorimeter = BuildEnvelopeCalorimeter(logicSingleCuRod, worldMat);
+    new G4PVPlacement(detRot, G4ThreeVector(0,0,0), logicCalorimeter, "PhysCalorimeter",
+                      logicWorld, false, 0, fCheckOverlaps);
+  }
+  else {
+    PlaceRodsInWorld(logicWorld, logicSingleCuRod, detRot);
+  }
+  timer.Stop();
+
+  // 通道编号表（光纤 touchable -> 铜棒编号），所有线程共用
+  ChannelGeometry channels;
+  channels.rodPerTower = RodPerTower;
+  channels.towerPerSide = 4;
+  channels.nScintFiber = nScintFiber;
+  channels.nCerenkovFiber = nCerenkovFiber;
+  channels.rodDepth = (fRodModel == RodModel::Flat) ? 1 : 2;
+  if (fLayout == Layout::Lattice) {
+    channels.addressing = ChannelGeometry::Addressing::Lattice;
+  }
+  else if (fLayout == Layout::Replica) {
+    channels.addressing = ChannelGeometry::Addressing::Replica;
+    channels.towerDepth = channels.rodDepth + (fTowerHasCore ? 4 : 3);
+  }
+  else if (fEnvelope == Envelope::Tower) {
+    channels.addressing = ChannelGeometry::Addressing::TowerCopy;
+  }
+  fChannelMap.Build(channels);
+
+  // 5. 解析重叠检查（结果按几何常数缓存）；完整的 Geant4 表面采样检查需用 /B2/det/checkOverlaps 打开
+  LatticeGeometry lattice;
+  lattice.rodX = CuRod_x;
+  lattice.rodY = CuRod_y;
+  lattice.rodLength = CuRod_length;
+  lattice.holeR = CuRod_holeR;
+  lattice.fiberR = Fiber_d/2;
+  lattice.rodSpacing = CuRod_spacing;
+  lattice.towerSpacing = Tower_spacing;
+  lattice.rodPerTower = RodPerTower;
+  lattice.towerPerSide = 4;
+  lattice.worldXY = world_xy;
+  lattice.worldZ = world_z;
+  lattice.rotation = *detRot;
+  lattice.rotatePerRod = (fLayout == Layout::Placement && fEnvelope == Envelope::None);
+  lattice.fiberPos = fFiberPositions;
+  if (!LatticeValidator(lattice).Validate(fOverlapCacheFile)) {
+    // checkOverlaps 打开时 Geant4 已逐个放置报告过重叠，由用户判断；否则不能带着重叠运行
+    G4ExceptionDescription msg;
+    msg << "Lattice overlap check failed (details in " << fOverlapCacheFile << "). Fix the geometry, "
+        << "or set /B2/det/checkOverlaps true to inspect it with the full Geant4 check.";
+    G4Exception("DetectorConstruction::Construct()", "B2Geom003",
+                fCheckOverlaps ? JustWarning : FatalException, msg);
+  }
+
+  static const char* layoutNames[] = { "placement", "replica", "lattice" };
+  static const char* envelopeNames[] = { "none", "calorimeter", "tower" };
+  static const char* rodModelNames[] = { "nested", "flat" };
+  G4cout << G4endl << "### Rod layout: " << layoutNames[G4int(fLayout)]
+         << ", envelope: " << (fLayout != Layout::Placement ? "calorimeter" : envelopeNames[G4int(fEnvelope)])
+         << ", rod model: " << rodModelNames[G4int(fRodModel)]
+         << ", " << G4PhysicalVolumeStore::GetInstance()->size() << " physical volumes, built in "
+         << timer.GetRealElapsed() << " s" << G4endl;
+
+  // killLate：所有逻辑体共用一个时间上限，飞行中越过积分门的径迹由 G4UserSpecialCuts 停止
+  // （不需要逐步的用户动作）；上限在每个 run 开始时由 UpdateTimeLimit() 设定
+  if (!fTimeLimits) {
+    fTimeLimits = std::make_unique<G4UserLimits>();
+  }
+  for (auto lv : *G4LogicalVolumeStore::GetInstance()) {
+    if (!lv->GetUserLimits()) {
+      lv->SetUserLimits(fTimeLimits.get());
+    }
+  }
+  UpdateTimeLimit();
+
+  //
+  //always return the physical World
+  //
+  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ConstructSDandField()
+{
+  if (fReadout != Readout::SD) {
+    return;
+  }
+
+  // 每个线程各自创建灵敏探测器
+  auto sdManager = G4SDManager::GetSDMpointer();
+
+  auto scintSD = new FiberSD("ScintFiberSD", "ScintFiberHits", FiberType::Scint, this);
+  sdManager->AddNewDetector(scintSD);
+  SetSensitiveDetector(fScoringVolume, scintSD);
+
+  auto cerenkovSD = new FiberSD("CerenkovFiberSD", "CerenkovFiberHits", FiberType::Cerenkov, this);
+  sdManager->AddNewDetector(cerenkovSD);
+  SetSensitiveDetector(fScoringVolumeCerenkov, cerenkovSD);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::UpdateTimeLimit() const
+{
+  // 几何由所有线程共用：只在主线程上、工作线程的 run 开始之前修改
+  if (fTimeLimits) {
+    fTimeLimits->SetUserMaxTime(fReadoutParameters.GetKillTime());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 逐根放置：每根铜棒都是世界体的直接子体积，并各自绕自身中心旋转
+void DetectorConstruction::PlaceRodsInWorld(G4LogicalVolume* logicWorld, G4LogicalVolume* logicRod,
+                                            G4RotationMatrix* rot)
+{
   for (G4int towerID = 0; towerID < TowerTotal; towerID++)  // 外层循环：16个tower
   {
     G4int towerX_ID = towerID % 4;  // x方向4个tower(0-1-2-3)
@@ -149,15 +342,257 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
         // 放置单根铜棒（关联tower位置+探测器旋转，无几何重叠）
         G4String rodName = "PhysCuRod_Tower" + std::to_string(towerID) + "_" + std::to_string(i) + "_" + std::to_string(j);
-        new G4PVPlacement(detRot, rodPos, logicSingleCuRod, rodName,
-                          logicWorld, false, towerID*RodPerTower*RodPerTower + i*RodPerTower + j, true);
+        new G4PVPlacement(rot, rodPos, logicRod, rodName,
+                          logicWorld, false, towerID*RodPerTower*RodPerTower + i*RodPerTower + j, fCheckOverlaps);
       }
     }
   }
-  //
-  //always return the physical World
-  //
-  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 包络体：轴对齐的铜棒阵列放在 LogicCalorimeter 中，由调用者整体旋转。
+// Envelope::Tower 时再加16个 LogicTower 包络体，它们共用同一个含256根铜棒的逻辑体，
+// 此时铜棒拷贝号为 i*16 + j，tower 拷贝号为 towerID。
+G4LogicalVolume* DetectorConstruction::BuildEnvelopeCalorimeter(G4LogicalVolume* logicRod, G4Material* air)
+{
+  const G4int nTowerXY = 4;
+  const G4double calo_xy = nTowerXY * Tower_spacing;
+
+  G4Box* solidCalorimeter = new G4Box("Calorimeter", calo_xy/2, calo_xy/2, CuRod_length/2);
+  G4LogicalVolume* logicCalorimeter = new G4LogicalVolume(solidCalorimeter, air, "LogicCalorimeter");
+
+  G4LogicalVolume* logicTower = nullptr;
+  if (fEnvelope == Envelope::Tower) {
+    G4Box* solidTower = new G4Box("Tower", Tower_spacing/2, Tower_spacing/2, CuRod_length/2);
+    logicTower = new G4LogicalVolume(solidTower, air, "LogicTower");
+
+    for (G4int i = 0; i < RodPerTower; i++)
+    {
+      for (G4int j = 0; j < RodPerTower; j++)
+      {
+        G4ThreeVector rodPos((i - RodPerTower/2 + 0.5) * CuRod_spacing,
+                             (j - RodPerTower/2 + 0.5) * CuRod_spacing, 0);
+        new G4PVPlacement(0, rodPos, logicRod, "PhysCuRod", logicTower, false,
+                          i*RodPerTower + j, fCheckOverlaps);
+      }
+    }
+  }
+
+  for (G4int towerID = 0; towerID < TowerTotal; towerID++)
+  {
+    G4double tower_x_pos = (towerID % nTowerXY - 1.5) * Tower_spacing;
+    G4double tower_y_pos = (towerID / nTowerXY - 1.5) * Tower_spacing;
+
+    if (logicTower) {
+      new G4PVPlacement(0, G4ThreeVector(tower_x_pos, tower_y_pos, 0), logicTower, "PhysTower",
+                        logicCalorimeter, false, towerID, fCheckOverlaps);
+      continue;
+    }
+
+    for (G4int i = 0; i < RodPerTower; i++)
+    {
+      for (G4int j = 0; j < RodPerTower; j++)
+      {
+        G4ThreeVector rodPos((i - RodPerTower/2 + 0.5) * CuRod_spacing + tower_x_pos,
+                             (j - RodPerTower/2 + 0.5) * CuRod_spacing + tower_y_pos, 0);
+        new G4PVPlacement(0, rodPos, logicRod, "PhysCuRod", logicCalorimeter, false,
+                          towerID*RodPerTower*RodPerTower + i*RodPerTower + j, fCheckOverlaps);
+      }
+    }
+  }
+
+  return logicCalorimeter;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 复制体层级：Calorimeter -> TowerRow(y, 4) -> Tower(x, 4) -> RodColumn(x, 16) -> RodCell(y, 16) -> 铜棒
+// 复制体编号与逐根放置的编号一致：towerID = towerY*4 + towerX，铜棒编号 = towerID*256 + i*16 + j
+G4LogicalVolume* DetectorConstruction::BuildReplicaCalorimeter(G4LogicalVolume* logicRod, G4Material* air)
+{
+  const G4int nTowerXY = 4;
+  const G4double calo_xy = nTowerXY * Tower_spacing;
+  const G4double towerCore_xy = RodPerTower * CuRod_spacing;
+
+  G4Box* solidCalorimeter = new G4Box("Calorimeter", calo_xy/2, calo_xy/2, CuRod_length/2);
+  G4LogicalVolume* logicCalorimeter = new G4LogicalVolume(solidCalorimeter, air, "LogicCalorimeter");
+
+  // tower行（y方向）
+  G4Box* solidTowerRow = new G4Box("TowerRow", calo_xy/2, Tower_spacing/2, CuRod_length/2);
+  G4LogicalVolume* logicTowerRow = new G4LogicalVolume(solidTowerRow, air, "LogicTowerRow");
+  new G4PVReplica("PhysTowerRow", logicTowerRow, logicCalorimeter, kYAxis, nTowerXY, Tower_spacing);
+
+  // tower（x方向）
+  G4Box* solidTower = new G4Box("Tower", Tower_spacing/2, Tower_spacing/2, CuRod_length/2);
+  G4LogicalVolume* logicTower = new G4LogicalVolume(solidTower, air, "LogicTower");
+  new G4PVReplica("PhysTower", logicTower, logicTowerRow, kXAxis, nTowerXY, Tower_spacing);
+
+  // tower之间有间隙时，铜棒阵列放在居中的内芯中（复制体必须填满母体）
+  G4LogicalVolume* logicRodMother = logicTower;
+  fTowerHasCore = (Tower_spacing - towerCore_xy) > 1.0e-9 * mm;
+  if (fTowerHasCore) {
+    G4Box* solidTowerCore = new G4Box("TowerCore", towerCore_xy/2, towerCore_xy/2, CuRod_length/2);
+    logicRodMother = new G4LogicalVolume(solidTowerCore, air, "LogicTowerCore");
+    new G4PVPlacement(0, G4ThreeVector(0,0,0), logicRodMother, "PhysTowerCore", logicTower, false, 0, fCheckOverlaps);
+  }
+
+  // 铜棒列（x方向，编号i）
+  G4Box* solidRodColumn = new G4Box("RodColumn", CuRod_spacing/2, towerCore_xy/2, CuRod_length/2);
+  G4LogicalVolume* logicRodColumn = new G4LogicalVolume(solidRodColumn, air, "LogicRodColumn");
+  new G4PVReplica("PhysRodColumn", logicRodColumn, logicRodMother, kXAxis, RodPerTower, CuRod_spacing);
+
+  // 铜棒单元（y方向，编号j），单元内居中放置一根铜棒
+  G4Box* solidRodCell = new G4Box("RodCell", CuRod_spacing/2, CuRod_spacing/2, CuRod_length/2);
+  G4LogicalVolume* logicRodCell = new G4LogicalVolume(solidRodCell, air, "LogicRodCell");
+  new G4PVReplica("PhysRodCell", logicRodCell, logicRodColumn, kYAxis, RodPerTower, CuRod_spacing);
+
+  new G4PVPlacement(0, G4ThreeVector(0,0,0), logicRod, "PhysCuRod", logicRodCell, false, 0, fCheckOverlaps);
+
+  return logicCalorimeter;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 规则点阵：Calorimeter -> RodColumn(x, 64) -> RodCell(y, 64) -> 铜棒
+// tower 之间没有间隙时，整个铜棒矩阵就是一个 64×64 的规则点阵，只需两层复制体，
+// G4ReplicaNavigation 直接由坐标算出所在单元，无需体素搜索
+G4LogicalVolume* DetectorConstruction::BuildLatticeCalorimeter(G4LogicalVolume* logicRod, G4Material* air)
+{
+  const G4int nTowerXY = 4;
+  const G4int nRodXY = nTowerXY * RodPerTower;
+  const G4double calo_xy = nRodXY * CuRod_spacing;
+
+  G4Box* solidCalorimeter = new G4Box("Calorimeter", calo_xy/2, calo_xy/2, CuRod_length/2);
+  G4LogicalVolume* logicCalorimeter = new G4LogicalVolume(solidCalorimeter, air, "LogicCalorimeter");
+
+  G4Box* solidRodColumn = new G4Box("RodColumn", CuRod_spacing/2, calo_xy/2, CuRod_length/2);
+  G4LogicalVolume* logicRodColumn = new G4LogicalVolume(solidRodColumn, air, "LogicRodColumn");
+  new G4PVReplica("PhysRodColumn", logicRodColumn, logicCalorimeter, kXAxis, nRodXY, CuRod_spacing);
+
+  G4Box* solidRodCell = new G4Box("RodCell", CuRod_spacing/2, CuRod_spacing/2, CuRod_length/2);
+  G4LogicalVolume* logicRodCell = new G4LogicalVolume(solidRodCell, air, "LogicRodCell");
+  new G4PVReplica("PhysRodCell", logicRodCell, logicRodColumn, kYAxis, nRodXY, CuRod_spacing);
+
+  new G4PVPlacement(0, G4ThreeVector(0,0,0), logicRod, "PhysCuRod", logicRodCell, false, 0, fCheckOverlaps);
+
+  return logicCalorimeter;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DetectorConstruction::GetNumberOfRods() const
+{
+  return TowerTotal * RodPerTower * RodPerTower;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DetectorConstruction::GetNumberOfTowers() const
+{
+  return TowerTotal;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DetectorConstruction::GetFiberLength() const
+{
+  return CuRod_length;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetLayout(G4String name)
+{
+  if (name == "replica") {
+    fLayout = Layout::Replica;
+  }
+  else if (name == "lattice") {
+    fLayout = Layout::Lattice;
+  }
+  else {
+    fLayout = Layout::Placement;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetEnvelope(G4String name)
+{
+  if (name == "calorimeter") {
+    fEnvelope = Envelope::Calorimeter;
+  }
+  else if (name == "tower") {
+    fEnvelope = Envelope::Tower;
+  }
+  else {
+    fEnvelope = Envelope::None;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetRodModel(G4String name)
+{
+  fRodModel = (name == "flat") ? RodModel::Flat : RodModel::Nested;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetReadout(G4String name)
+{
+  fReadout = (name == "sd") ? Readout::SD : Readout::Stepping;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/B2/det/", "Detector construction control");
+
+  auto& layoutCmd = fMessenger->DeclareMethod("layout", &DetectorConstruction::SetLayout,
+    "Rod layout: placement (4096 placements in world), replica (nested replica towers) "
+    "or lattice (single 64x64 replica lattice).");
+  layoutCmd.SetParameterName("layout", false);
+  layoutCmd.SetCandidates("placement replica lattice");
+  layoutCmd.SetDefaultValue("placement");
+  layoutCmd.SetStates(G4State_PreInit);
+
+  auto& envelopeCmd = fMessenger->DeclareMethod("envelope", &DetectorConstruction::SetEnvelope,
+    "Envelope for the placement layout: none (rods rotated individually in the world), "
+    "calorimeter (axis-aligned rods in one rotated calorimeter volume) or "
+    "tower (calorimeter plus 16 tower envelopes).");
+  envelopeCmd.SetParameterName("envelope", false);
+  envelopeCmd.SetCandidates("none calorimeter tower");
+  envelopeCmd.SetDefaultValue("none");
+  envelopeCmd.SetStates(G4State_PreInit);
+
+  auto& rodModelCmd = fMessenger->DeclareMethod("rodModel", &DetectorConstruction::SetRodModel,
+    "Rod model: nested (Cu rod -> air hole -> fibers) or "
+    "flat (fibers and a boolean air hole directly inside the Cu rod).");
+  rodModelCmd.SetParameterName("model", false);
+  rodModelCmd.SetCandidates("nested flat");
+  rodModelCmd.SetDefaultValue("nested");
+  rodModelCmd.SetStates(G4State_PreInit);
+
+  auto& readoutCmd = fMessenger->DeclareMethod("readout", &DetectorConstruction::SetReadout,
+    "Photon readout: stepping (SteppingAction on every step) or "
+    "sd (sensitive detectors on the fiber volumes only).");
+  readoutCmd.SetParameterName("readout", false);
+  readoutCmd.SetCandidates("stepping sd");
+  readoutCmd.SetDefaultValue("stepping");
+  readoutCmd.SetStates(G4State_PreInit);
+
+  auto& overlapCmd = fMessenger->DeclareProperty("checkOverlaps", fCheckOverlaps,
+    "Run the full Geant4 surface-sampling overlap check on every placement.");
+  overlapCmd.SetParameterName("check", true);
+  overlapCmd.SetDefaultValue("true");
+  overlapCmd.SetStates(G4State_PreInit);
+
+  auto& cacheCmd = fMessenger->DeclareProperty("overlapCache", fOverlapCacheFile,
+    "File caching the analytic lattice overlap check, keyed by a hash of the geometry constants.");
+  cacheCmd.SetParameterName("file", false);
+  cacheCmd.SetStates(G4State_PreInit);
 }
 
 }
@@ -0,0 +1,171 @@
+/// \file B2/src/Digitizer.cc
+/// \brief Implementation of the B2::Digitizer class
+
+// Digitizer.cc：光子数 -> 光电子 -> SiPM/PMT 响应 -> ADC（结构数组，逐通道循环可向量化）
+#include "Digitizer.hh"
+#include "DigitizerParameters.hh"
+#include "FiberHitsCollection.hh"
+#include "PhotonSampler.hh"
+
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Digitizer::Calibrate(const DigitizerParameters& parameters, G4int nRods)
+{
+  fNRods = nRods;
+  fVersion = parameters.GetVersion();
+
+  std::size_t nChannels = 2*nRods;
+  for (auto buffer : { &fPhotons, &fPE, &fExtraMean, &fNormal, &fSignal }) {
+    buffer->assign(nChannels, 0.);
+  }
+  fExtra.assign(nChannels, 0);
+  fADC.assign(nChannels, 0);
+  fGain.assign(nChannels, parameters.GetGain());
+  fPedestal.assign(nChannels, parameters.GetPedestal());
+  fNoise.assign(nChannels, parameters.GetNoise());
+
+  for (const auto& calibration : parameters.GetCalibration()) {
+    if (calibration.rod >= nRods) {
+      continue;
+    }
+    G4int channel = GetChannel(calibration.type, calibration.rod);
+    fGain[channel] = calibration.gain;
+    fPedestal[channel] = calibration.pedestal;
+    fNoise[channel] = calibration.noise;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Digitizer::Digitize(const FiberHitsCollection* scintHits,
+                         const FiberHitsCollection* cerenkovHits,
+                         const DigitizerParameters& parameters, PhotonSampler& sampler)
+{
+  G4int nRods = scintHits ? scintHits->GetNumberOfChannels()
+                          : (cerenkovHits ? cerenkovHits->GetNumberOfChannels() : 0);
+  if (nRods != fNRods || parameters.GetVersion() != fVersion) {
+    Calibrate(parameters, nRods);
+  }
+  const G4int n = 2*fNRods;
+
+  // 1. 输入：被击中通道的光子数
+  std::fill(fPhotons.begin(), fPhotons.end(), 0.);
+  fHit.clear();
+  G4int offset = 0;
+  for (auto hits : { scintHits, cerenkovHits }) {
+    if (hits) {
+      for (G4int rod : hits->GetFiredChannels()) {
+        G4int nPhotons = hits->GetPhotons(rod);
+        if (nPhotons > 0) {
+          fPhotons[offset + rod] = nPhotons;
+          fHit.push_back(offset + rod);
+        }
+      }
+    }
+    offset += fNRods;
+  }
+
+  // 2. 探测效率：被击中通道上的二项抽样
+  DetectPhotons(parameters, sampler);
+
+  // 3. 串扰、后脉冲（正比于光电子数）与暗计数：所有通道一次批量泊松抽样
+  const G4double extraPerPE = parameters.GetCrosstalk() + parameters.GetAfterpulse();
+  const G4double dark = parameters.GetDarkCountsPerWindow();
+  const G4double* pe = fPE.data();
+  G4double* extraMean = fExtraMean.data();
+  for (G4int i = 0; i < n; i++) {
+    extraMean[i] = pe[i]*extraPerPE + dark;
+  }
+  sampler.Sample(fExtraMean.data(), fExtra.data(), n);
+  sampler.Normal(fNormal.data(), n);
+
+  // 4. 像素饱和：std::exp 在不开 -ffast-math 时没有向量版本，单独一趟（不饱和时跳过）
+  const G4int* extra = fExtra.data();
+  G4double* signal = fSignal.data();
+  for (G4int i = 0; i < n; i++) {
+    signal[i] = pe[i] + extra[i];
+  }
+  const G4double pixels = parameters.GetPixels();
+  if (pixels > 0.) {
+    const G4double invPixels = 1./pixels;
+    for (G4int i = 0; i < n; i++) {
+      signal[i] = pixels*(1. - std::exp(-signal[i]*invPixels));
+    }
+  }
+
+  // 5. 增益、台阶、噪声与 ADC 量化：先截断到 [0, adcMax]，取整即为向下取整，不需要 std::floor
+  const G4double* gain = fGain.data();
+  const G4double* pedestal = fPedestal.data();
+  const G4double* noise = fNoise.data();
+  const G4double* normal = fNormal.data();
+  G4int* adc = fADC.data();
+  const G4double adcMax = parameters.GetADCMax();
+  for (G4int i = 0; i < n; i++) {
+    G4double value = pedestal[i] + gain[i]*signal[i] + noise[i]*normal[i] + 0.5;
+    adc[i] = G4int(std::min(std::max(value, 0.), adcMax));
+  }
+
+  // 6. 零压缩
+  fFired.clear();
+  const G4double threshold = parameters.GetThreshold();
+  for (G4int i = 0; i < n; i++) {
+    if (adc[i] - pedestal[i] > threshold) {
+      fFired.push_back(i);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 光电子数 ~ Binomial(光子数, PDE)：小光子数 CDF 逆变换，大光子数正态近似
+void Digitizer::DetectPhotons(const DigitizerParameters& parameters, PhotonSampler& sampler)
+{
+  std::fill(fPE.begin(), fPE.end(), 0.);
+  std::size_t nHit = fHit.size();
+  fUniform.resize(2*nHit);
+  sampler.Uniform(fUniform.data(), 2*nHit);
+
+  for (std::size_t k = 0; k < nHit; k++) {
+    G4int channel = fHit[k];
+    G4int nPhotons = G4int(fPhotons[channel]);
+    G4double p = parameters.GetPDE(channel < fNRods ? FiberType::Scint : FiberType::Cerenkov);
+    G4double u = fUniform[2*k];
+
+    G4int nPE = 0;
+    if (p >= 1.) {
+      nPE = nPhotons;
+    }
+    else if (p <= 0.) {
+      nPE = 0;
+    }
+    else if (nPhotons < kBinomialThreshold) {
+      G4double ratio = p / (1. - p);
+      G4double prob = std::pow(1. - p, nPhotons);
+      G4double cdf = prob;
+      while (u > cdf && nPE < nPhotons) {
+        prob *= ratio * (nPhotons - nPE) / (nPE + 1);
+        nPE++;
+        cdf += prob;
+      }
+    }
+    else {
+      G4double mean = nPhotons*p;
+      G4double sigma = std::sqrt(mean*(1. - p));
+      G4double z = std::sqrt(-2.*std::log(u)) * std::cos(twopi*fUniform[2*k + 1]);
+      nPE = std::min(nPhotons, std::max(0, G4int(std::floor(mean + sigma*z + 0.5))));
+    }
+    fPE[channel] = nPE;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,259 @@
+/// \file B2/src/DigitizerParameters.cc
+/// \brief Implementation of the B2::DigitizerParameters class
+
+#include "DigitizerParameters.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DigitizerParameters::DigitizerParameters()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DigitizerParameters::~DigitizerParameters()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 每行：<scint|cerenkov> <rod> <gain/(ADC/pe)> <pedestal/ADC> [noise/ADC]，# 之后为注释
+void DigitizerParameters::LoadCalibrationFile(G4String fileName)
+{
+  fCalibration.clear();
+  fVersion++;
+  if (fileName == "none") {
+    return;
+  }
+
+  std::ifstream in(fileName);
+  if (!in) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open calibration file " << fileName << ", using the default gain and pedestal.";
+    G4Exception("DigitizerParameters::LoadCalibrationFile()", "B2Digi001", JustWarning, msg);
+    return;
+  }
+
+  std::string line;
+  G4int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string fiber;
+    Calibration calibration { FiberType::Scint, 0, 0., 0., fNoise };
+    if (!(fields >> fiber)) {
+      continue;
+    }
+    if (!(fields >> calibration.rod >> calibration.gain >> calibration.pedestal)
+        || (fiber != "scint" && fiber != "cerenkov") || calibration.rod < 0 || calibration.gain <= 0.) {
+      G4ExceptionDescription msg;
+      msg << fileName << ":" << lineNumber << ": expected <scint|cerenkov> <rod> <gain> "
+          << "<pedestal> [noise], line ignored.";
+      G4Exception("DigitizerParameters::LoadCalibrationFile()", "B2Digi001", JustWarning, msg);
+      continue;
+    }
+    fields >> calibration.noise;
+    calibration.type = (fiber == "scint") ? FiberType::Scint : FiberType::Cerenkov;
+    fCalibration.push_back(calibration);
+  }
+  G4cout << "### Digitizer calibration " << fileName << ": " << fCalibration.size()
+         << " channels" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DigitizerParameters::LoadTemplateFile(G4String fileName)
+{
+  fPulseTemplate.clear();
+  fVersion++;
+  if (fileName == "none") {
+    return;
+  }
+
+  std::ifstream in(fileName);
+  if (!in) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open pulse template " << fileName << ", using the analytic pulse shape.";
+    G4Exception("DigitizerParameters::LoadTemplateFile()", "B2Digi001", JustWarning, msg);
+    return;
+  }
+
+  std::string line;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    G4double value = 0.;
+    if (fields >> value) {
+      fPulseTemplate.push_back(value);
+    }
+  }
+
+  // 峰值归一为1（幅度以单光子峰值为单位）
+  G4double peak = fPulseTemplate.empty() ? 0.
+    : *std::max_element(fPulseTemplate.begin(), fPulseTemplate.end());
+  if (peak <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "Pulse template " << fileName << " has no positive sample, using the analytic pulse shape.";
+    G4Exception("DigitizerParameters::LoadTemplateFile()", "B2Digi001", JustWarning, msg);
+    fPulseTemplate.clear();
+    return;
+  }
+  for (auto& value : fPulseTemplate) {
+    value /= peak;
+  }
+  G4cout << "### Pulse template " << fileName << ": " << fPulseTemplate.size()
+         << " samples" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DigitizerParameters::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/B2/digi/", "SiPM/PMT digitisation");
+
+  auto& enableCmd = fMessenger->DeclareProperty("enable", fEnabled,
+    "Run the digitisation at end of event and write the zero-suppressed ADC values.");
+  enableCmd.SetParameterName("flag", false);
+  enableCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& scintPdeCmd = fMessenger->DeclareProperty("scintPDE", fPDE[G4int(FiberType::Scint)],
+    "Photo-detection efficiency for the scintillation light.");
+  scintPdeCmd.SetParameterName("pde", false);
+  scintPdeCmd.SetRange("pde>=0 && pde<=1");
+  scintPdeCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& cerenkovPdeCmd = fMessenger->DeclareProperty("cerenkovPDE", fPDE[G4int(FiberType::Cerenkov)],
+    "Photo-detection efficiency for the Cerenkov light.");
+  cerenkovPdeCmd.SetParameterName("pde", false);
+  cerenkovPdeCmd.SetRange("pde>=0 && pde<=1");
+  cerenkovPdeCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& pixelsCmd = fMessenger->DeclareMethod("pixels", &DigitizerParameters::SetPixels,
+    "SiPM pixels per channel for the saturation N(1-exp(-n/N)); 0 = PMT, no saturation.");
+  pixelsCmd.SetParameterName("n", false);
+  pixelsCmd.SetRange("n>=0");
+  pixelsCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& crosstalkCmd = fMessenger->DeclareProperty("crosstalk", fCrosstalk,
+    "Optical crosstalk probability per photoelectron.");
+  crosstalkCmd.SetParameterName("p", false);
+  crosstalkCmd.SetRange("p>=0 && p<1");
+  crosstalkCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& afterpulseCmd = fMessenger->DeclareProperty("afterpulse", fAfterpulse,
+    "Afterpulse probability per photoelectron within the integration window.");
+  afterpulseCmd.SetParameterName("p", false);
+  afterpulseCmd.SetRange("p>=0 && p<1");
+  afterpulseCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& darkCmd = fMessenger->DeclarePropertyWithUnit("darkRate", "kHz", fDarkRate,
+    "Dark count rate per channel.");
+  darkCmd.SetParameterName("rate", false);
+  darkCmd.SetRange("rate>=0");
+  darkCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& windowCmd = fMessenger->DeclarePropertyWithUnit("window", "ns", fWindow,
+    "Integration window used for the dark counts.");
+  windowCmd.SetParameterName("time", false);
+  windowCmd.SetRange("time>=0");
+  windowCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& bitsCmd = fMessenger->DeclareProperty("adcBits", fADCBits,
+    "ADC resolution; values are clamped to [0, 2^bits-1].");
+  bitsCmd.SetParameterName("bits", false);
+  bitsCmd.SetRange("bits>0 && bits<31");
+  bitsCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& thresholdCmd = fMessenger->DeclareProperty("threshold", fThreshold,
+    "Zero-suppression threshold in ADC counts above the pedestal.");
+  thresholdCmd.SetParameterName("adc", false);
+  thresholdCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& gainCmd = fMessenger->DeclareMethod("gain", &DigitizerParameters::SetGain,
+    "Default gain (ADC counts per photoelectron) of channels not in the calibration file.");
+  gainCmd.SetParameterName("adcPerPE", false);
+  gainCmd.SetRange("adcPerPE>0");
+  gainCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& pedestalCmd = fMessenger->DeclareMethod("pedestal", &DigitizerParameters::SetPedestal,
+    "Default pedestal (ADC counts) of channels not in the calibration file.");
+  pedestalCmd.SetParameterName("adc", false);
+  pedestalCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& noiseCmd = fMessenger->DeclareMethod("noise", &DigitizerParameters::SetNoise,
+    "Default baseline noise sigma (ADC counts).");
+  noiseCmd.SetParameterName("adc", false);
+  noiseCmd.SetRange("adc>=0");
+  noiseCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& fileCmd = fMessenger->DeclareMethod("calibrationFile", &DigitizerParameters::LoadCalibrationFile,
+    "Per-channel calibration, one '<scint|cerenkov> <rod> <gain> <pedestal> [noise]' per line; "
+    "none clears.");
+  fileCmd.SetParameterName("file", false);
+  fileCmd.SetStates(G4State_PreInit, G4State_Idle);
+  fileCmd.SetToBeBroadcasted(false);
+
+  auto& waveformCmd = fMessenger->DeclareProperty("waveform", fWaveform,
+    "Synthesise per-channel waveforms and write amplitude, integral, peak time and "
+    "time over threshold.");
+  waveformCmd.SetParameterName("flag", false);
+  waveformCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& periodCmd = fMessenger->DeclarePropertyWithUnit("samplingPeriod", "ns", fSamplingPeriod,
+    "ADC sampling period of the waveforms (1 ns = 1 GS/s).");
+  periodCmd.SetParameterName("period", false);
+  periodCmd.SetRange("period>0");
+  periodCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& samplesCmd = fMessenger->DeclareProperty("samples", fSamples,
+    "Samples per waveform, starting at global time 0.");
+  samplesCmd.SetParameterName("n", false);
+  samplesCmd.SetRange("n>0");
+  samplesCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& waveThresholdCmd = fMessenger->DeclareProperty("waveformThreshold", fWaveformThreshold,
+    "Threshold of the time over threshold, in single-photon peak amplitudes.");
+  waveThresholdCmd.SetParameterName("amplitude", false);
+  waveThresholdCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& riseCmd = fMessenger->DeclarePropertyWithUnit("riseTime", "ns", fRiseTime,
+    "Rise time of the analytic single-photon pulse (1-exp(-t/rise))*exp(-t/fall).");
+  riseCmd.SetParameterName("time", false);
+  riseCmd.SetRange("time>0");
+  riseCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& fallCmd = fMessenger->DeclarePropertyWithUnit("fallTime", "ns", fFallTime,
+    "Fall time of the analytic single-photon pulse.");
+  fallCmd.SetParameterName("time", false);
+  fallCmd.SetRange("time>0");
+  fallCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& templateCmd = fMessenger->DeclareMethod("templateFile", &DigitizerParameters::LoadTemplateFile,
+    "Single-photon pulse sampled at the sampling period, one value per line; "
+    "none restores the analytic shape.");
+  templateCmd.SetParameterName("file", false);
+  templateCmd.SetStates(G4State_PreInit, G4State_Idle);
+  templateCmd.SetToBeBroadcasted(false);
+
+  auto& writeCmd = fMessenger->DeclareProperty("writeWaveforms", fWriteWaveforms,
+    "Also write the sampled waveforms (large), not only their features.");
+  writeCmd.SetParameterName("flag", false);
+  writeCmd.SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
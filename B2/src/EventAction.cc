@@ -4,10 +4,19 @@
 // EventAction.cc：事例动作（单个事例的信号累加）
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "DetectorConstruction.hh"
+#include "LoadBalancer.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Run.hh"
 #include "G4RunManager.hh"
-#include "G4AnalysisManager.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+
+#include <chrono>
+#include <cmath>
 
 namespace B2
 {
@@ -20,33 +29,132 @@ EventAction::EventAction(RunAction* runAction)  // ← 构造函数定义开始
   G4UserEventAction(),              // 调用基类构造函数
   fRunAction(runAction)           // 初始化成员指针
 { // 构造函数体开始
-    // 这里可以放复杂的初始化代码
-    // 但当前示例中是空的
-} 
+  fDetector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 // 事例开始时：将光子数总数置0（避免跨事例数据污染）
 void EventAction::BeginOfEventAction(const G4Event*)
 {
+  fEventStart = std::chrono::steady_clock::now();
   fScintPhotonTotal = 0;
   fCerenkovPhotonTotal = 0;
+
+  // 读出方式在 /run/initialize 之前设定，这里每个事例读取一次（串行模式下本类构造得更早）
+  fUseSD = (fDetector->GetReadout() == DetectorConstruction::Readout::SD);
+  if (!fUseSD) {
+    if (!fOwnScintHits) {
+      // stepping 模式：每线程一份、只分配一次的通道数组
+      G4int nChannels = fDetector->GetNumberOfRods();
+      fOwnScintHits = std::make_unique<FiberHitsCollection>("SteppingAction", "ScintFiberHits", nChannels);
+      fOwnCerenkovHits = std::make_unique<FiberHitsCollection>("SteppingAction", "CerenkovFiberHits", nChannels);
+    }
+    fScintHits = fOwnScintHits.get();
+    fCerenkovHits = fOwnCerenkovHits.get();
+    // 时间分格只在 run 编号变化时重设（读出参数只在两次 run 之间改变）
+    G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    if (runID != fRunID) {
+      const ReadoutParameters& parameters = fDetector->GetReadoutParameters();
+      fScintHits->SetTimeBinning(parameters.GetTimeBins(), parameters.GetTimeBinWidth());
+      fCerenkovHits->SetTimeBinning(parameters.GetTimeBins(), parameters.GetTimeBinWidth());
+      fRunID = runID;
+    }
+    fScintHits->Clear();
+    fCerenkovHits->Clear();
+  }
+  fNSteps = 0;
+  fNFiberSteps = 0;
+
+  // 计数器型随机数的密钥，每个事例取自 G4Random（结果仍由事例种子决定）
+  fSampler.SeedFromEngine();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 // 事例结束时：可在此将光子数传递给RunAction（如写入ROOT文件）
-void EventAction::EndOfEventAction(const G4Event*)
+void EventAction::EndOfEventAction(const G4Event* event)
 {
-  auto man = G4AnalysisManager::Instance();
+  CollectHits(event);
+
+  // 批量泊松抽样（逐步缓存的步，或延迟抽样时每个通道一次）
+  if (fScintHits) fScintHits->Sample(fSampler);
+  if (fCerenkovHits) fCerenkovHits->Sample(fSampler);
+
+  // 积分门（按时间格取整）：门外的光子只保留在时间分布中
+  const ReadoutParameters& parameters = fDetector->GetReadoutParameters();
+  if (parameters.HasGate()) {
+    G4double width = parameters.GetTimeBinWidth();
+    G4int firstBin = G4int(std::floor(parameters.GetGateStart() / width));
+    G4int endBin = G4int(std::ceil(parameters.GetGateEnd() / width));
+    for (auto hits : { fScintHits, fCerenkovHits }) {
+      if (hits) hits->ApplyGate(firstBin, endBin);
+    }
+  }
+
+  // 数字化与波形（耗时计入 run 结束时的统计）
+  const DigitizerParameters& digiParameters = fDetector->GetDigitizerParameters();
+  const Digitizer* digitizer = nullptr;
+  const WaveformSynthesizer* waveforms = nullptr;
+  if (digiParameters.IsEnabled() || digiParameters.IsWaveformEnabled()) {
+    auto start = std::chrono::steady_clock::now();
+    if (digiParameters.IsEnabled()) {
+      fDigitizer.Digitize(fScintHits, fCerenkovHits, digiParameters, fSampler);
+      digitizer = &fDigitizer;
+    }
+    if (digiParameters.IsWaveformEnabled()) {
+      fWaveforms.Process(fScintHits, fCerenkovHits, digiParameters);
+      waveforms = &fWaveforms;
+    }
+    std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - start;
+    fRunAction->AddDigitizationTime(elapsed.count());
+  }
+
+  fScintPhotonTotal = fScintHits ? fScintHits->GetTotal() : 0;
+  fCerenkovPhotonTotal = fCerenkovHits ? fCerenkovHits->GetTotal() : 0;
+
   // G4cout << "闪烁总数：" << fScintPhotonTotal << G4endl;
   // G4cout << "切伦科夫总数：" << fCerenkovPhotonTotal << G4endl;
-  man->FillNtupleIColumn(0, fScintPhotonTotal);
-  man->FillNtupleIColumn(1, fCerenkovPhotonTotal);
-  man->AddNtupleRow();
+  fRunAction->FillPhotonTree(event, fScintHits, fCerenkovHits, digitizer, waveforms);
 
+  fRunAction->AddSteps(fNSteps, fNFiberSteps);
+
+  // 事例耗时与初级粒子能量，用于估计后续事例的代价
+  if (event->GetNumberOfPrimaryVertex() > 0) {
+    std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - fEventStart;
+    G4double energy = event->GetPrimaryVertex()->GetPrimary()->GetKineticEnergy();
+    LoadBalancer::Instance().RecordEvent(energy / GeV, elapsed.count());
+  }
 }
     
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void EventAction::CollectHits(const G4Event* event)
+{
+  if (!fUseSD) {
+    return;
+  }
+
+  if (fScintHCID < 0) {
+    auto sdManager = G4SDManager::GetSDMpointer();
+    fScintHCID = sdManager->GetCollectionID("ScintFiberSD/ScintFiberHits");
+    fCerenkovHCID = sdManager->GetCollectionID("CerenkovFiberSD/CerenkovFiberHits");
+  }
+
+  fScintHits = nullptr;
+  fCerenkovHits = nullptr;
+  auto hce = event->GetHCofThisEvent();
+  if (!hce) {
+    return;
+  }
+  fScintHits = static_cast<FiberHitsCollection*>(hce->GetHC(fScintHCID));
+  fCerenkovHits = static_cast<FiberHitsCollection*>(hce->GetHC(fCerenkovHCID));
+  // 集合属于 FiberSD（每线程一个，下个事例清除后复用），不能随事例一起删除
+  hce->AddHitsCollection(fScintHCID, nullptr);
+  hce->AddHitsCollection(fCerenkovHCID, nullptr);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 }
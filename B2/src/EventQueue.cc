@@ -0,0 +1,37 @@
+/// \file B2/src/EventQueue.cc
+/// \brief Implementation of the B2::EventQueue class
+
+#include "EventQueue.hh"
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventQueue::EventQueue(std::size_t capacity)
+{
+  Resize(capacity);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventQueue::Resize(std::size_t capacity)
+{
+  std::size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  if (size == fSlots.size()) {
+    return;
+  }
+  fSlots.clear();
+  fSlots.shrink_to_fit();
+  fSlots.resize(size);
+  fMask = size - 1;
+  fHead.store(0, std::memory_order_relaxed);
+  fTail.store(0, std::memory_order_relaxed);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
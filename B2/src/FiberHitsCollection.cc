@@ -0,0 +1,141 @@
+/// \file B2/src/FiberHitsCollection.cc
+/// \brief Implementation of the B2::FiberHitsCollection class
+
+#include "FiberHitsCollection.hh"
+#include "PhotonSampler.hh"
+
+#include <algorithm>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FiberHitsCollection::FiberHitsCollection(const G4String& detName, const G4String& colName,
+                                         G4int nChannels)
+: G4VHitsCollection(detName, colName),
+  fPhotons(nChannels, 0),
+  fMean(nChannels, 0.),
+  fBinPhotons(nChannels, 0),
+  fBinMean(nChannels, 0.),
+  fTimeProfile(1, 0)
+{
+  fFired.reserve(nChannels);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberHitsCollection::SetTimeBinning(G4int nBins, G4double binWidth)
+{
+  nBins = std::max(nBins, 1);
+  if (nBins == fNTimeBins && binWidth == fTimeBinWidth) {
+    return;
+  }
+  Clear();
+  fNTimeBins = nBins;
+  fTimeBinWidth = binWidth;
+  fInvTimeBinWidth = binWidth > 0. ? 1. / binWidth : 0.;
+  fBinPhotons.assign(fPhotons.size() * nBins, 0);
+  fBinMean.assign(fPhotons.size() * nBins, 0.);
+  fTimeProfile.assign(nBins, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberHitsCollection::Clear()
+{
+  for (G4int channel : fFired) {
+    fPhotons[channel] = 0;
+    fMean[channel] = 0.;
+    std::fill_n(fBinPhotons.begin() + channel*fNTimeBins, fNTimeBins, 0);
+    std::fill_n(fBinMean.begin() + channel*fNTimeBins, fNTimeBins, 0.);
+  }
+  fFired.clear();
+  std::fill(fTimeProfile.begin(), fTimeProfile.end(), 0);
+  fStepChannel.clear();
+  fStepMean.clear();
+  fStepBin.clear();
+  fTotal = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberHitsCollection::FoldSteps()
+{
+  for (std::size_t i = 0; i < fStepMean.size(); i++) {
+    G4int channel = fStepChannel[i];
+    if (fPhotons[channel] == 0 && fMean[channel] == 0.) fFired.push_back(channel);
+    fMean[channel] += fStepMean[i];
+    fBinMean[channel*fNTimeBins + fStepBin[i]] += fStepMean[i];
+  }
+  fStepChannel.clear();
+  fStepMean.clear();
+  fStepBin.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberHitsCollection::Sample(PhotonSampler& sampler)
+{
+  // 1. 缓存的步：每步一个泊松数
+  std::size_t nSteps = fStepMean.size();
+  if (nSteps > 0) {
+    fCounts.resize(nSteps);
+    sampler.Sample(fStepMean.data(), fCounts.data(), nSteps);
+    for (std::size_t i = 0; i < nSteps; i++) {
+      Add(fStepChannel[i], fStepBin[i], fCounts[i]);
+    }
+    fStepChannel.clear();
+    fStepMean.clear();
+    fStepBin.clear();
+  }
+
+  // 2. 按通道、时间格累加的平均值：每个非空时间格一个泊松数
+  fMeanBuffer.clear();
+  fIndexBuffer.clear();
+  for (G4int channel : fFired) {
+    if (fMean[channel] == 0.) {
+      continue;
+    }
+    G4int first = channel * fNTimeBins;
+    for (G4int index = first; index < first + fNTimeBins; index++) {
+      if (fBinMean[index] > 0.) {
+        fMeanBuffer.push_back(fBinMean[index]);
+        fIndexBuffer.push_back(index);
+      }
+    }
+  }
+  std::size_t nMeans = fMeanBuffer.size();
+  fCounts.resize(nMeans);
+  sampler.Sample(fMeanBuffer.data(), fCounts.data(), nMeans);
+  for (std::size_t i = 0; i < nMeans; i++) {
+    G4int index = fIndexBuffer[i];
+    fPhotons[index / fNTimeBins] += fCounts[i];
+    fBinPhotons[index] += fCounts[i];
+    fTimeProfile[index % fNTimeBins] += fCounts[i];
+    fTotal += fCounts[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberHitsCollection::ApplyGate(G4int firstBin, G4int endBin)
+{
+  // 最后一格同时收集所有更晚的光子，不能算在门内
+  firstBin = std::max(firstBin, 0);
+  endBin = std::min(endBin, fNTimeBins - 1);
+  fTotal = 0;
+  for (G4int channel : fFired) {
+    G4int first = channel * fNTimeBins;
+    G4int nPhotons = 0;
+    for (G4int bin = firstBin; bin < endBin; bin++) {
+      nPhotons += fBinPhotons[first + bin];
+    }
+    fPhotons[channel] = nPhotons;
+    fTotal += nPhotons;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
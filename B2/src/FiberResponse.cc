@@ -0,0 +1,126 @@
+/// \file B2/src/FiberResponse.cc
+/// \brief Implementation of the B2::FiberResponse class
+
+// FiberResponse.cc：光纤内单步的光子产额（SteppingAction 与 FiberSD 共用）
+#include "FiberResponse.hh"
+#include "ReadoutParameters.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double FiberResponse::ScintillationMean(const G4Step* step) const
+{
+  G4double edep = step->GetTotalEnergyDeposit(); // 沉积能量
+  if (edep <= 0) {
+    return 0.;
+  }
+  return edep * fScintillationYield;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double FiberResponse::CerenkovMean(const G4Step* step)
+{
+  // 1. 按粒子种类取产额表；中性粒子的阈值为 DBL_MAX，低于阈值只需一次比较
+  const G4Track* track = step->GetTrack();
+  const CerenkovTable& table = GetCerenkovTable(track->GetParticleDefinition());
+
+  G4double kineticEnergy = track->GetKineticEnergy(); // 步末（径迹当前）动能
+  if (fAverageBeta) {
+    kineticEnergy = 0.5*(step->GetPreStepPoint()->GetKineticEnergy() + kineticEnergy);
+  }
+  if (kineticEnergy <= table.threshold) {
+    return 0.;
+  }
+
+  // 2. 查表得到单位长度光子数，乘以步长
+  return table.dNdx.Value(kineticEnergy) * step->GetStepLength();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double FiberResponse::MeanPhotons(FiberType type, const G4Step* step, G4double& time)
+{
+  G4double mean = (type == FiberType::Scint) ? ScintillationMean(step) : CerenkovMean(step);
+  if (mean <= 0.) {
+    return 0.;
+  }
+
+  // 步中点在光纤局部坐标系中的 z（光纤轴沿铜棒，读出端在 +z）
+  const G4StepPoint* preStep = step->GetPreStepPoint();
+  const G4StepPoint* postStep = step->GetPostStepPoint();
+  G4ThreeVector midPoint = 0.5*(preStep->GetPosition() + postStep->GetPosition());
+  G4double z = preStep->GetTouchable()->GetHistory()->GetTopTransform().TransformPoint(midPoint).z();
+  const LightTransport::Point& point = fTransport.Lookup(type, z);
+  time = 0.5*(preStep->GetGlobalTime() + postStep->GetGlobalTime()) + point.delay;
+  return mean * point.response;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberResponse::BeginOfRun(const ReadoutParameters& parameters, G4double fiberLength)
+{
+  fAverageBeta = parameters.GetCerenkovAverageBeta();
+  fCerenkovTables.clear();
+  fTransport.Build(parameters, fiberLength);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const FiberResponse::CerenkovTable&
+FiberResponse::GetCerenkovTable(const G4ParticleDefinition* particle)
+{
+  G4int id = particle->GetParticleDefinitionID();
+  if (id < 0) {
+    return fNoYield;
+  }
+  if (id >= G4int(fCerenkovTables.size())) {
+    fCerenkovTables.resize(id + 1);
+  }
+  CerenkovTable& table = fCerenkovTables[id];
+  if (!table.built) {
+    BuildCerenkovTable(particle, table);
+  }
+  return table;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// dN/dx = 369/cm × (1 - 1/(β²n²))，β² = 1 - 1/γ²，γ = 1 + T/m
+void FiberResponse::BuildCerenkovTable(const G4ParticleDefinition* particle,
+                                       CerenkovTable& table) const
+{
+  table.built = true;
+  G4double mass = particle->GetPDGMass();
+  if (particle->GetPDGCharge() == 0. || mass <= 0.) {
+    table.threshold = DBL_MAX;
+    return;
+  }
+
+  G4double gammaThreshold = 1.0 / std::sqrt(1.0 - fBetaThreshold*fBetaThreshold);
+  table.threshold = mass * (gammaThreshold - 1.0);
+
+  G4int nBins = fTableDecades * fTableBinsPerDecade;
+  table.dNdx = G4PhysicsLogVector(table.threshold, table.threshold * std::pow(10., fTableDecades), nBins);
+  for (G4int i = 0; i <= nBins; i++) {
+    G4double gamma = 1.0 + table.dNdx.Energy(i) / mass;
+    G4double beta2 = 1.0 - 1.0/(gamma*gamma);
+    G4double yield = fCerenkovDNdx * (1.0 - 1.0/(beta2*fRefIndex*fRefIndex));
+    table.dNdx.PutValue(i, std::max(yield, 0.));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
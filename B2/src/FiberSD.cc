@@ -0,0 +1,81 @@
+/// \file B2/src/FiberSD.cc
+/// \brief Implementation of the B2::FiberSD class
+
+// FiberSD.cc：光纤灵敏探测器（只在光纤内的步被调用）
+#include "FiberSD.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4HCofThisEvent.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FiberSD::FiberSD(const G4String& name, const G4String& hitsCollectionName,
+                 FiberType type, const DetectorConstruction* detector)
+: G4VSensitiveDetector(name),
+  fType(type),
+  fDetector(detector)
+{
+  collectionName.insert(hitsCollectionName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FiberSD::Initialize(G4HCofThisEvent* hce)
+{
+  // 每线程一个集合，只分配一次；每个事例只清除被击中的通道
+  if (!fHitsCollection) {
+    fHitsCollection = std::make_unique<FiberHitsCollection>(SensitiveDetectorName, collectionName[0],
+                                                            fDetector->GetNumberOfRods());
+  }
+
+  // 灵敏探测器没有 run 开始的回调：run 编号变化时重置光子产额表与时间分格
+  // （读出参数只在两次 run 之间改变）
+  G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  if (runID != fRunID) {
+    const ReadoutParameters& parameters = fDetector->GetReadoutParameters();
+    fResponse.BeginOfRun(parameters, fDetector->GetFiberLength());
+    fHitsCollection->SetTimeBinning(parameters.GetTimeBins(), parameters.GetTimeBinWidth());
+    fRunID = runID;
+  }
+  fHitsCollection->Clear();
+
+  // Add this collection in hce
+  // HCE 在事例删除时会 delete 其中的集合：EventAction::CollectHits 取出后把该项置空
+  if (fHitsCollectionID < 0) {
+    fHitsCollectionID = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection.get());
+  }
+  hce->AddHitsCollection(fHitsCollectionID, fHitsCollection.get());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FiberSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  G4double arrivalTime = 0.;
+  G4double meanPhotons = fResponse.MeanPhotons(fType, step, arrivalTime);
+  if (meanPhotons <= 0.) {
+    return false;
+  }
+
+  G4int channel = fDetector->GetChannelMap().GetRodID(step->GetPreStepPoint()->GetTouchable());
+
+  // 泊松抽样由 EventAction 在事例结束时批量进行；延迟抽样时每个通道只抽一次
+  if (fDetector->GetReadoutParameters().GetSampling() == ReadoutParameters::Sampling::Event) {
+    fHitsCollection->AddMean(channel, meanPhotons, arrivalTime);
+  }
+  else {
+    fHitsCollection->AddStep(channel, meanPhotons, arrivalTime);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
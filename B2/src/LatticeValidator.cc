@@ -0,0 +1,233 @@
+/// \file B2/src/LatticeValidator.cc
+/// \brief Implementation of the B2::LatticeValidator class
+
+// LatticeValidator.cc：铜棒阵列的解析重叠检查（结果按几何常数哈希缓存）
+#include "LatticeValidator.hh"
+
+#include "G4GeometryTolerance.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace B2
+{
+
+namespace
+{
+  // FNV-1a 64位哈希
+  void HashBytes(std::uint64_t& hash, const void* data, std::size_t size)
+  {
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  void HashValue(std::uint64_t& hash, G4double value) { HashBytes(hash, &value, sizeof(value)); }
+  void HashValue(std::uint64_t& hash, G4int value) { HashBytes(hash, &value, sizeof(value)); }
+
+  // 旋转后盒子在母体坐标系中的半宽（物体旋转 = 坐标系旋转的逆）
+  G4ThreeVector RotatedHalfExtent(const G4RotationMatrix& frameRot, const G4ThreeVector& half)
+  {
+    G4RotationMatrix objRot = frameRot.inverse();
+    return G4ThreeVector(
+      std::abs(objRot.xx())*half.x() + std::abs(objRot.xy())*half.y() + std::abs(objRot.xz())*half.z(),
+      std::abs(objRot.yx())*half.x() + std::abs(objRot.yy())*half.y() + std::abs(objRot.yz())*half.z(),
+      std::abs(objRot.zx())*half.x() + std::abs(objRot.zy())*half.y() + std::abs(objRot.zz())*half.z());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LatticeValidator::LatticeValidator(const LatticeGeometry& geometry)
+: fGeometry(geometry),
+  fTolerance(G4GeometryTolerance::GetInstance()->GetSurfaceTolerance())
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t LatticeValidator::GetHash() const
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  const auto& g = fGeometry;
+  for (G4double value : { g.rodX, g.rodY, g.rodLength, g.holeR, g.fiberR,
+                          g.rodSpacing, g.towerSpacing, g.worldXY, g.worldZ,
+                          g.rotation.xx(), g.rotation.xy(), g.rotation.xz(),
+                          g.rotation.yx(), g.rotation.yy(), g.rotation.yz(),
+                          g.rotation.zx(), g.rotation.zy(), g.rotation.zz() }) {
+    HashValue(hash, value);
+  }
+  HashValue(hash, g.rodPerTower);
+  HashValue(hash, g.towerPerSide);
+  HashValue(hash, G4int(g.rotatePerRod));
+  for (const auto& pos : g.fiberPos) {
+    HashValue(hash, pos.x());
+    HashValue(hash, pos.y());
+    HashValue(hash, pos.z());
+  }
+  return hash;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool LatticeValidator::Validate(const G4String& cacheFile) const
+{
+  std::ostringstream hashText;
+  hashText << std::hex << GetHash();
+
+  // 1. 缓存中的哈希与当前几何一致时直接采用缓存结果
+  std::ifstream in(cacheFile);
+  std::string key, cachedHash, cachedResult;
+  if (in >> key >> cachedHash >> cachedResult
+      && key == "B2LatticeHash" && cachedHash == hashText.str()) {
+    G4cout << "### Lattice overlap check: " << cachedResult
+           << " (cached in " << cacheFile << ")" << G4endl;
+    if (cachedResult != "PASS") {
+      G4ExceptionDescription msg;
+      msg << "Cached lattice overlap check failed, see " << cacheFile
+          << " or enable /B2/det/checkOverlaps for the full Geant4 check.";
+      G4Exception("LatticeValidator::Validate()", "B2Geom002", JustWarning, msg);
+    }
+    return cachedResult == "PASS";
+  }
+  in.close();
+
+  // 2. 重新检查并写缓存
+  std::vector<G4String> problems;
+  G4bool ok = Check(problems);
+
+  std::ofstream out(cacheFile);
+  out << "B2LatticeHash " << hashText.str() << " " << (ok ? "PASS" : "FAIL") << "\n";
+  for (const auto& problem : problems) {
+    out << problem << "\n";
+  }
+
+  G4cout << "### Lattice overlap check: " << (ok ? "PASS" : "FAIL")
+         << " (hash " << hashText.str() << ", written to " << cacheFile << ")" << G4endl;
+  if (!ok) {
+    G4ExceptionDescription msg;
+    msg << "Lattice overlap check failed:";
+    for (const auto& problem : problems) {
+      msg << G4endl << "  " << problem;
+    }
+    G4Exception("LatticeValidator::Validate()", "B2Geom002", JustWarning, msg);
+  }
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool LatticeValidator::Check(std::vector<G4String>& problems) const
+{
+  G4bool ok = CheckRodInternals(problems);
+  ok = CheckRodNeighbours(problems) && ok;
+  ok = CheckContainment(problems) && ok;
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 孔在铜棒内、光纤在孔内、光纤之间不重叠
+G4bool LatticeValidator::CheckRodInternals(std::vector<G4String>& problems) const
+{
+  const auto& g = fGeometry;
+  G4bool ok = true;
+
+  if (g.holeR > std::min(g.rodX, g.rodY)/2 + fTolerance) {
+    problems.push_back("hole radius " + std::to_string(g.holeR/mm) + " mm exceeds the rod half width");
+    ok = false;
+  }
+
+  for (std::size_t k = 0; k < g.fiberPos.size(); k++) {
+    if (g.fiberPos[k].perp() + g.fiberR > g.holeR + fTolerance) {
+      problems.push_back("fiber " + std::to_string(k) + " sticks out of the hole");
+      ok = false;
+    }
+    for (std::size_t l = k + 1; l < g.fiberPos.size(); l++) {
+      if ((g.fiberPos[k] - g.fiberPos[l]).perp() < 2*g.fiberR - fTolerance) {
+        problems.push_back("fibers " + std::to_string(k) + " and " + std::to_string(l) + " overlap");
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 相邻铜棒不重叠。同取向的两个盒子只需沿盒子自身三个轴做分离轴检查
+G4bool LatticeValidator::CheckRodNeighbours(std::vector<G4String>& problems) const
+{
+  const auto& g = fGeometry;
+  G4bool ok = true;
+
+  G4double towerGap = g.towerSpacing - g.rodPerTower * g.rodSpacing;
+  if (towerGap < -fTolerance) {
+    problems.push_back("rods of one tower (" + std::to_string(g.rodPerTower * g.rodSpacing/mm)
+                       + " mm) do not fit in the tower spacing (" + std::to_string(g.towerSpacing/mm) + " mm)");
+    ok = false;
+  }
+
+  // 塔内相邻、对角相邻，以及跨越tower边界的相邻铜棒
+  G4double s = g.rodSpacing;
+  G4double sTower = g.rodSpacing + std::max(towerGap, 0.);
+  const G4ThreeVector offsets[] = {
+    G4ThreeVector(s, 0, 0), G4ThreeVector(0, s, 0),
+    G4ThreeVector(s, s, 0), G4ThreeVector(s, -s, 0),
+    G4ThreeVector(sTower, 0, 0), G4ThreeVector(0, sTower, 0)
+  };
+
+  G4RotationMatrix rodFrame = g.rotatePerRod ? g.rotation : G4RotationMatrix();
+  for (const auto& offset : offsets) {
+    G4ThreeVector local = rodFrame * offset;
+    if (std::abs(local.x()) < g.rodX - fTolerance
+        && std::abs(local.y()) < g.rodY - fTolerance
+        && std::abs(local.z()) < g.rodLength - fTolerance) {
+      std::ostringstream problem;
+      problem << "rods at lattice offset (" << offset.x()/mm << ", " << offset.y()/mm
+              << ") mm overlap (local separation " << local.x()/mm << ", " << local.y()/mm << " mm)";
+      problems.push_back(problem.str());
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 旋转后的铜棒（或整个量能器）仍在世界体内
+G4bool LatticeValidator::CheckContainment(std::vector<G4String>& problems) const
+{
+  const auto& g = fGeometry;
+  G4double lattice_xy = g.towerPerSide * g.towerSpacing;
+
+  G4ThreeVector extent;
+  if (g.rotatePerRod) {
+    G4ThreeVector rodExtent =
+      RotatedHalfExtent(g.rotation, G4ThreeVector(g.rodX/2, g.rodY/2, g.rodLength/2));
+    G4double outerRod = (g.towerPerSide/2. - 0.5) * g.towerSpacing
+                        + (g.rodPerTower/2. - 0.5) * g.rodSpacing;
+    extent = G4ThreeVector(outerRod + rodExtent.x(), outerRod + rodExtent.y(), rodExtent.z());
+  }
+  else {
+    extent = RotatedHalfExtent(g.rotation, G4ThreeVector(lattice_xy/2, lattice_xy/2, g.rodLength/2));
+  }
+
+  if (extent.x() > g.worldXY/2 + fTolerance || extent.y() > g.worldXY/2 + fTolerance
+      || extent.z() > g.worldZ/2 + fTolerance) {
+    std::ostringstream problem;
+    problem << "rotated calorimeter (half extent " << extent.x()/mm << ", " << extent.y()/mm
+            << ", " << extent.z()/mm << " mm) does not fit in the world";
+    problems.push_back(problem.str());
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,73 @@
+/// \file B2/src/LightTransport.cc
+/// \brief Implementation of the B2::LightTransport class
+
+// LightTransport.cc：光纤内光的衰减与前端镜面反射（按 z 分格查表）
+#include "LightTransport.hh"
+#include "ReadoutParameters.hh"
+
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LightTransport::Build(const ReadoutParameters& parameters, G4double fiberLength)
+{
+  fHalfLength = fiberLength / 2;
+  G4double binWidth = fiberLength / fNBins;
+  fInvBinWidth = 1. / binWidth;
+
+  G4double reflectivity = parameters.GetMirrorReflectivity();
+  for (auto type : { FiberType::Scint, FiberType::Cerenkov }) {
+    G4double invVelocity = parameters.GetGroupIndex(type) / CLHEP::c_light;
+    auto& table = fTable[G4int(type)];
+    table.resize(fNBins);
+    for (G4int bin = 0; bin < fNBins; bin++) {
+      // 格中心到读出端的距离；反射光多走到前端再返回的路程
+      G4double distance = fiberLength - (bin + 0.5) * binWidth;
+      G4double response = Transmission(parameters, type, distance);
+      if (reflectivity > 0.) {
+        response += reflectivity * Transmission(parameters, type, 2*fiberLength - distance);
+      }
+      table[bin] = { fCollectionEfficiency * response, distance * invVelocity };
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 有测量曲线时线性插值（超出最后一点后按衰减长度外推），否则 exp(-d/λ)
+G4double LightTransport::Transmission(const ReadoutParameters& parameters, FiberType type,
+                                      G4double distance) const
+{
+  G4double length = parameters.GetAttenuationLength(type);
+  const auto& curve = parameters.GetTransmissionCurve(type);
+
+  if (curve.empty()) {
+    return length > 0. ? std::exp(-distance / length) : 1.;
+  }
+  if (distance <= curve.front().distance) {
+    return curve.front().transmission;
+  }
+
+  auto upper = std::upper_bound(curve.begin(), curve.end(), distance,
+    [](G4double d, const ReadoutParameters::TransmissionPoint& point) {
+      return d < point.distance;
+    });
+  if (upper == curve.end()) {
+    const auto& last = curve.back();
+    return length > 0. ? last.transmission * std::exp(-(distance - last.distance) / length)
+                       : last.transmission;
+  }
+  auto lower = upper - 1;
+  G4double f = (distance - lower->distance) / (upper->distance - lower->distance);
+  return lower->transmission + f * (upper->transmission - lower->transmission);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
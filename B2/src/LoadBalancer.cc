@@ -0,0 +1,171 @@
+/// \file B2/src/LoadBalancer.cc
+/// \brief Implementation of the B2::LoadBalancer class
+
+// LoadBalancer.cc：按能量估计事例耗时，决定每次分发的事例数，并统计负载均衡
+#include "LoadBalancer.hh"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LoadBalancer& LoadBalancer::Instance()
+{
+  static LoadBalancer instance;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LoadBalancer::ElapsedSeconds() const
+{
+  std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - fRunStart;
+  return elapsed.count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LoadBalancer::BeginRun(G4int nEvents, std::function<G4double(G4int)> plannedEnergy)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fRunStart = std::chrono::steady_clock::now();
+  fWorkers.clear();
+  fChunks = 0;
+  fMinChunk = 0;
+  fMaxChunk = 0;
+
+  // 代价模型在 run 之间保留（遗忘因子让它跟随最近的事例）
+  fEnergySum.assign(std::max(nEvents, 0) + 1, 0.);
+  for (G4int event = 0; event < nEvents; event++) {
+    G4double energy = plannedEnergy ? plannedEnergy(event) : 1.;
+    fEnergySum[event + 1] = fEnergySum[event] + std::max(energy, 0.);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LoadBalancer::RecordEvent(G4double energy, G4double seconds)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  std::size_t thread = std::max(G4Threading::G4GetThreadId(), 0);
+  if (fWorkers.size() <= thread) {
+    fWorkers.resize(thread + 1);
+  }
+  fWorkers[thread].events++;
+  fWorkers[thread].busy += seconds;
+
+  fW = fForget * fW + 1.;
+  fE = fForget * fE + energy;
+  fEE = fForget * fEE + energy * energy;
+  fT = fForget * fT + seconds;
+  fET = fForget * fET + energy * seconds;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LoadBalancer::WorkerFinished()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  std::size_t thread = std::max(G4Threading::G4GetThreadId(), 0);
+  if (fWorkers.size() <= thread) {
+    fWorkers.resize(thread + 1);
+  }
+  fWorkers[thread].finished = ElapsedSeconds();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LoadBalancer::CostModel(G4double& c0, G4double& c1) const
+{
+  // 没有两种以上能量的历史时假设耗时与能量成正比（只有相对大小有用）
+  c0 = 0.;
+  c1 = 1.;
+  G4double det = fW * fEE - fE * fE;
+  if (fW < 2. || det <= 1e-6 * fW * fEE) {
+    return;
+  }
+  G4double slope = (fW * fET - fE * fT) / det;
+  G4double offset = (fT - slope * fE) / fW;
+  c1 = std::max(slope, 0.);
+  c0 = std::max(offset, 0.);
+  if (c0 == 0. && c1 == 0.) {
+    c0 = 1.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int LoadBalancer::ChunkSize(G4int firstEvent, G4int remaining, G4int nThreads)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  nThreads = std::max(nThreads, 1);
+  G4int chunk = std::max(remaining / (2 * nThreads), 1);
+
+  G4int end = firstEvent + remaining;
+  if (remaining > 0 && end < G4int(fEnergySum.size())) {
+    G4double c0, c1;
+    CostModel(c0, c1);
+    auto cost = [&](G4int a, G4int b) {
+      return c0 * (b - a) + c1 * (fEnergySum[b] - fEnergySum[a]);
+    };
+    // 剩余代价的 1/(2*线程数)：二分查找不超过目标的最多事例数
+    G4double target = cost(firstEvent, end) / (2 * nThreads);
+    G4int low = 1, high = remaining;
+    while (low < high) {
+      G4int mid = (low + high + 1) / 2;
+      if (cost(firstEvent, firstEvent + mid) <= target) low = mid;
+      else high = mid - 1;
+    }
+    chunk = low;
+  }
+  chunk = std::min(chunk, std::max(remaining, 1));
+
+  fChunks++;
+  fMinChunk = fChunks == 1 ? chunk : std::min(fMinChunk, chunk);
+  fMaxChunk = std::max(fMaxChunk, chunk);
+  return chunk;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LoadBalancer::PrintStatistics() const
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  G4int nWorkers = 0;
+  G4double sumBusy = 0., maxBusy = 0.;
+  G4double firstDone = DBL_MAX, lastDone = 0.;
+  for (const auto& worker : fWorkers) {
+    if (worker.events == 0 && worker.finished < 0.) {
+      continue;
+    }
+    nWorkers++;
+    sumBusy += worker.busy;
+    maxBusy = std::max(maxBusy, worker.busy);
+    if (worker.finished >= 0.) {
+      firstDone = std::min(firstDone, worker.finished);
+      lastDone = std::max(lastDone, worker.finished);
+    }
+  }
+  if (nWorkers == 0 || sumBusy <= 0.) {
+    return;
+  }
+
+  // 不均衡度 = 最忙线程 / 平均 - 1；效率 = 总忙碌时间 / (线程数 × 最后结束时刻)
+  G4double meanBusy = sumBusy / nWorkers;
+  G4cout << G4endl << " Load balance: " << nWorkers << " worker(s), busy mean " << meanBusy
+         << " s max " << maxBusy << " s (imbalance " << 100. * (maxBusy / meanBusy - 1.) << " %)";
+  if (lastDone > 0.) {
+    G4cout << ", finished between " << firstDone << " and " << lastDone << " s"
+           << " (efficiency " << 100. * sumBusy / (nWorkers * lastDone) << " %)";
+  }
+  if (fChunks > 0) {
+    G4cout << ", " << fChunks << " adaptive chunks of " << fMinChunk << "-" << fMaxChunk << " events";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,403 @@
+/// \file B2/src/OutputSink.cc
+/// \brief Implementation of the B2::RawSink, B2::ColumnFile and B2::ColumnarSink classes
+
+#include "OutputSink.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RawSink::~RawSink()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool RawSink::Open(const G4String& fileName, G4int nTowers)
+{
+  fFileName = fileName;
+  fFile = std::fopen(fileName.c_str(), "wb");
+  if (!fFile) {
+    return false;
+  }
+  fBuffer.reserve(kBufferSize);
+  fBuffer.clear();
+  fBytesWritten = 0.;
+  fFailed = false;
+
+  const char magic[8] = "B2RAW01";
+  Append(magic, sizeof(magic));
+  Append(&nTowers, sizeof(nTowers));
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RawSink::Write(const EventRecord& record)
+{
+  const G4int head[3] = { record.eventID, record.scintTotal, record.cerenkovTotal };
+  Append(head, sizeof(head));
+  Append(&record.energy, sizeof(record.energy));
+  Append(record.scintTower.data(), record.scintTower.size()*sizeof(G4int));
+  Append(record.cerenkovTower.data(), record.cerenkovTower.size()*sizeof(G4int));
+
+  G4int nScint = G4int(record.scintChannel.size());
+  Append(&nScint, sizeof(nScint));
+  Append(record.scintChannel.data(), nScint*sizeof(G4int));
+  Append(record.scintCount.data(), nScint*sizeof(G4int));
+
+  G4int nCerenkov = G4int(record.cerenkovChannel.size());
+  Append(&nCerenkov, sizeof(nCerenkov));
+  Append(record.cerenkovChannel.data(), nCerenkov*sizeof(G4int));
+  Append(record.cerenkovCount.data(), nCerenkov*sizeof(G4int));
+
+  if (fBuffer.size() >= kBufferSize) {
+    Flush();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RawSink::Close()
+{
+  if (!fFile) {
+    return;
+  }
+  Flush();
+  if (std::fclose(fFile) != 0) {
+    fFailed = true;
+  }
+  fFile = nullptr;
+
+  if (fFailed) {
+    G4ExceptionDescription msg;
+    msg << "Writing " << fFileName << " failed after " << fBytesWritten << " bytes;"
+        << " the later records were dropped and the file is truncated.";
+    G4Exception("RawSink::Close()", "B2Output003", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RawSink::Append(const void* data, std::size_t bytes)
+{
+  auto begin = static_cast<const char*>(data);
+  fBuffer.insert(fBuffer.end(), begin, begin + bytes);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RawSink::Flush()
+{
+  if (!fBuffer.empty() && !fFailed) {
+    std::size_t written = std::fwrite(fBuffer.data(), 1, fBuffer.size(), fFile);
+    fBytesWritten += written;
+    if (written != fBuffer.size()) {
+      fFailed = true;
+    }
+  }
+  fBuffer.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnFile::~ColumnFile()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#if defined(__unix__) || defined(__APPLE__)
+
+G4bool ColumnFile::Open(const G4String& path)
+{
+  fFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  fSize = 0;
+  fFailed = false;
+  fMap = nullptr;
+  fMapOffset = 0;
+  fMapUsed = 0;
+  return fFd >= 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnFile::Append(const void* data, std::size_t bytes)
+{
+  auto src = static_cast<const char*>(data);
+  while (bytes > 0) {
+    if (fFailed) {
+      return;
+    }
+    if (!fMap || fMapUsed == kChunk) {
+      Remap();
+      if (!fMap) {
+        fFailed = true;
+        return;
+      }
+    }
+    std::size_t n = std::min(bytes, kChunk - fMapUsed);
+    std::memcpy(fMap + fMapUsed, src, n);
+    fMapUsed += n;
+    fSize += n;
+    src += n;
+    bytes -= n;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 映射窗口写满后解除映射，把文件扩展一个窗口并映射下一段
+void ColumnFile::Remap()
+{
+  if (fMap) {
+    ::munmap(fMap, kChunk);
+    fMap = nullptr;
+    fMapOffset += kChunk;
+  }
+  fMapUsed = 0;
+  if (::ftruncate(fFd, fMapOffset + kChunk) != 0) {
+    return;
+  }
+  void* map = ::mmap(nullptr, kChunk, PROT_READ | PROT_WRITE, MAP_SHARED, fFd, fMapOffset);
+  if (map != MAP_FAILED) {
+    fMap = static_cast<char*>(map);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnFile::Close()
+{
+  if (fFd < 0) {
+    return;
+  }
+  if (fMap) {
+    ::munmap(fMap, kChunk);
+    fMap = nullptr;
+  }
+  // 截掉最后一个窗口未写的部分
+  if (::ftruncate(fFd, fSize) != 0) {
+    fFailed = true;
+  }
+  if (::close(fFd) != 0) {
+    fFailed = true;
+  }
+  fFd = -1;
+}
+
+#else
+
+G4bool ColumnFile::Open(const G4String& path)
+{
+  fFile = std::fopen(path.c_str(), "wb");
+  fSize = 0;
+  fFailed = false;
+  if (fFile) {
+    std::setvbuf(fFile, nullptr, _IOFBF, kChunk);
+  }
+  return fFile != nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnFile::Append(const void* data, std::size_t bytes)
+{
+  if (fFailed) {
+    return;
+  }
+  std::size_t written = std::fwrite(data, 1, bytes, fFile);
+  fSize += written;
+  if (written != bytes) {
+    fFailed = true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnFile::Remap() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnFile::Close()
+{
+  if (fFile) {
+    if (std::fclose(fFile) != 0) {
+      fFailed = true;
+    }
+    fFile = nullptr;
+  }
+}
+
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  // 列名、类型与文件名（与 ColumnarSink::Column 的顺序一致）
+  const char* const kColumnNames[] = {
+    "eventID", "S", "C", "energy", "scintTower", "cerenkovTower",
+    "scintChannel", "scintCount", "scintOffsets",
+    "cerenkovChannel", "cerenkovCount", "cerenkovOffsets"
+  };
+  const char* const kColumnTypes[] = {
+    "int32", "int32", "int32", "float64", "int32", "int32",
+    "int32", "int32", "int64",
+    "int32", "int32", "int64"
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarSink::~ColumnarSink()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ColumnarSink::Open(const G4String& fileName, G4int nTowers)
+{
+  fDirectory = fileName;
+  fNTowers = nTowers;
+  fNEvents = 0;
+  fScintOffset = 0;
+  fCerenkovOffset = 0;
+
+  std::error_code error;
+  std::filesystem::create_directories(fDirectory.c_str(), error);
+  if (error) {
+    return false;
+  }
+
+  for (G4int column = 0; column < kNColumns; column++) {
+    fColumns[column] = std::make_unique<ColumnFile>();
+    G4String type = kColumnTypes[column];
+    G4String path = fDirectory + "/" + kColumnNames[column] + "." + type;
+    if (!fColumns[column]->Open(path)) {
+      return false;
+    }
+  }
+
+  // 偏移量文件的第一个值为0
+  const G4long zero = 0;
+  fColumns[kScintOffsets]->Append(&zero, sizeof(zero));
+  fColumns[kCerenkovOffsets]->Append(&zero, sizeof(zero));
+  fOpen = true;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarSink::Write(const EventRecord& record)
+{
+  fColumns[kEventID]->Append(&record.eventID, sizeof(G4int));
+  fColumns[kScint]->Append(&record.scintTotal, sizeof(G4int));
+  fColumns[kCerenkov]->Append(&record.cerenkovTotal, sizeof(G4int));
+  fColumns[kEnergy]->Append(&record.energy, sizeof(G4double));
+  fColumns[kScintTower]->Append(record.scintTower.data(), fNTowers*sizeof(G4int));
+  fColumns[kCerenkovTower]->Append(record.cerenkovTower.data(), fNTowers*sizeof(G4int));
+
+  std::size_t nScint = record.scintChannel.size();
+  fColumns[kScintChannel]->Append(record.scintChannel.data(), nScint*sizeof(G4int));
+  fColumns[kScintCount]->Append(record.scintCount.data(), nScint*sizeof(G4int));
+  fScintOffset += nScint;
+  fColumns[kScintOffsets]->Append(&fScintOffset, sizeof(fScintOffset));
+
+  std::size_t nCerenkov = record.cerenkovChannel.size();
+  fColumns[kCerenkovChannel]->Append(record.cerenkovChannel.data(), nCerenkov*sizeof(G4int));
+  fColumns[kCerenkovCount]->Append(record.cerenkovCount.data(), nCerenkov*sizeof(G4int));
+  fCerenkovOffset += nCerenkov;
+  fColumns[kCerenkovOffsets]->Append(&fCerenkovOffset, sizeof(fCerenkovOffset));
+
+  ++fNEvents;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarSink::Close()
+{
+  if (!fOpen) {
+    return;
+  }
+  fOpen = false;
+  G4String failed;
+  for (G4int column = 0; column < kNColumns; column++) {
+    fColumns[column]->Close();
+    if (fColumns[column]->HasFailed()) {
+      failed += G4String(" ") + kColumnNames[column];
+    }
+  }
+
+  // 有列写失败时不写模式描述，以免把不完整的目录当作有效输出读入
+  if (!failed.empty()) {
+    G4ExceptionDescription msg;
+    msg << "Writing the columns" << failed << " of " << fDirectory << " failed after "
+        << fNEvents << " events were queued; the later data were dropped and"
+        << " schema.txt is not written.";
+    G4Exception("ColumnarSink::Close()", "B2Output003", JustWarning, msg);
+    return;
+  }
+
+  // 模式描述：列名 类型 每个事例的宽度（var 表示变长，后跟偏移量列）
+  std::ofstream schema(fDirectory + "/schema.txt");
+  schema << "B2COL 1\n"
+         << "events " << fNEvents << "\n"
+         << "towers " << fNTowers << "\n";
+  for (G4int column = 0; column < kNColumns; column++) {
+    schema << "column " << kColumnNames[column] << " " << kColumnTypes[column] << " ";
+    switch (column) {
+      case kScintTower:
+      case kCerenkovTower:
+        schema << fNTowers;
+        break;
+      case kScintChannel:
+      case kScintCount:
+        schema << "var scintOffsets";
+        break;
+      case kCerenkovChannel:
+      case kCerenkovCount:
+        schema << "var cerenkovOffsets";
+        break;
+      case kScintOffsets:
+      case kCerenkovOffsets:
+        schema << "offsets";
+        break;
+      default:
+        schema << 1;
+    }
+    schema << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ColumnarSink::GetBytesWritten() const
+{
+  G4double bytes = 0.;
+  for (const auto& column : fColumns) {
+    if (column) {
+      bytes += column->GetSize();
+    }
+  }
+  return bytes;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
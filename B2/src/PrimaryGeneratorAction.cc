@@ -14,6 +14,14 @@
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
 #include "G4Event.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UIcommand.hh"
+#include "G4UImanager.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
 
 namespace B2
 {
@@ -45,6 +53,7 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   // 5. 配置默认能量（可被宏文件覆盖，对应你的8个能量点需求）
   fParticleGun->SetParticleEnergy(20*GeV);
 
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -52,6 +61,8 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
   delete fParticleGun;
+  delete fMessenger;
+  delete fSpectrumMessenger;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -60,8 +71,400 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   //this function is called at the begining of ecah event
 
-  // 发射粒子（完成单个事例的初级粒子生成） 
-  fParticleGun->GeneratePrimaryVertex(anEvent); 
+  // 能量扫描或能谱：按事例号取本事例的能量，发射后恢复枪的能量
+  G4int point = GetScanPoint(anEvent->GetEventID());
+  if (point < 0 && fSpectrum == Spectrum::Fixed) {
+    // 发射粒子（完成单个事例的初级粒子生成） 
+    fParticleGun->GeneratePrimaryVertex(anEvent); 
+    return;
+  }
+  G4double gunEnergy = fParticleGun->GetParticleEnergy();
+  fParticleGun->SetParticleEnergy(point >= 0 ? fScanPoints[point].energy
+                                             : SampleEnergy(anEvent->GetEventID()));
+  fParticleGun->GeneratePrimaryVertex(anEvent);
+  fParticleGun->SetParticleEnergy(gunEnergy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int PrimaryGeneratorAction::GetScanPoint(G4int eventID) const
+{
+  if (!fScanEnabled || fScanOrder.empty()) {
+    return -1;
+  }
+  // 点数很少，线性查找；超出扫描事例数的事例归入最后一个点
+  for (std::size_t k = 0; k < fScanOrder.size(); k++) {
+    if (eventID < fScanEnd[k]) {
+      return fScanOrder[k];
+    }
+  }
+  return fScanOrder.back();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::GetMaxEnergy() const
+{
+  if (fScanEnabled && !fScanOrder.empty()) {
+    return fScanPoints[fScanOrder.front()].energy;
+  }
+  switch (fSpectrum) {
+    case Spectrum::List:
+      return *std::max_element(fEnergyList.begin(), fEnergyList.end());
+    case Spectrum::LogUniform:
+      return fMaxEnergy;
+    case Spectrum::Histogram:
+      return fEdges.back();
+    default:
+      return fParticleGun->GetParticleEnergy();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int PrimaryGeneratorAction::GetNumberOfEnergyBins() const
+{
+  if (fScanEnabled && !fScanOrder.empty()) {
+    return G4int(fScanPoints.size());
+  }
+  switch (fSpectrum) {
+    case Spectrum::List:
+      return G4int(fEnergyList.size());
+    case Spectrum::LogUniform:
+      return fLogBins;
+    case Spectrum::Histogram:
+      return G4int(fEdges.size()) - 1;
+    default:
+      return 1;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int PrimaryGeneratorAction::GetEnergyBin(G4int eventID, G4double energy) const
+{
+  if (fScanEnabled && !fScanOrder.empty()) {
+    return GetScanPoint(eventID);
+  }
+  switch (fSpectrum) {
+    case Spectrum::List:
+      return eventID % G4int(fEnergyList.size());
+    case Spectrum::LogUniform: {
+      G4int bin = G4int(fLogBins * std::log(energy / fMinEnergy) / std::log(fMaxEnergy / fMinEnergy));
+      return std::min(std::max(bin, 0), fLogBins - 1);
+    }
+    case Spectrum::Histogram: {
+      G4int bin = G4int(std::upper_bound(fEdges.begin(), fEdges.end(), energy) - fEdges.begin()) - 1;
+      return std::min(std::max(bin, 0), G4int(fEdges.size()) - 2);
+    }
+    default:
+      return 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::GetPlannedEnergy(G4int eventID) const
+{
+  G4int point = GetScanPoint(eventID);
+  if (point >= 0) {
+    return fScanPoints[point].energy;
+  }
+  switch (fSpectrum) {
+    case Spectrum::List:
+      return fEnergyList[eventID % fEnergyList.size()];
+    case Spectrum::LogUniform:
+      // 1/E 分布在 [min, max] 上的平均值
+      return (fMaxEnergy - fMinEnergy) / std::log(fMaxEnergy / fMinEnergy);
+    case Spectrum::Histogram: {
+      G4double mean = 0., previous = 0.;
+      for (std::size_t bin = 0; bin < fCumulative.size(); bin++) {
+        mean += (fCumulative[bin] - previous) * 0.5 * (fEdges[bin] + fEdges[bin + 1]);
+        previous = fCumulative[bin];
+      }
+      return mean;
+    }
+    default:
+      return fParticleGun->GetParticleEnergy();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::SampleEnergy(G4int eventID) const
+{
+  switch (fSpectrum) {
+    case Spectrum::List:
+      return fEnergyList[eventID % fEnergyList.size()];
+    case Spectrum::LogUniform:
+      return fMinEnergy * std::pow(fMaxEnergy / fMinEnergy, G4UniformRand());
+    case Spectrum::Histogram: {
+      // 按累积概率选分箱，箱内均匀
+      G4double u = G4UniformRand();
+      std::size_t bin = std::lower_bound(fCumulative.begin(), fCumulative.end(), u) - fCumulative.begin();
+      bin = std::min(bin, fCumulative.size() - 1);
+      return fEdges[bin] + G4UniformRand() * (fEdges[bin + 1] - fEdges[bin]);
+    }
+    default:
+      return fParticleGun->GetParticleEnergy();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::SetSpectrum(G4String name)
+{
+  if (name == "list" && !fEnergyList.empty()) {
+    fSpectrum = Spectrum::List;
+  }
+  else if (name == "logUniform" && HasLogRange()) {
+    fSpectrum = Spectrum::LogUniform;
+  }
+  else if (name == "histogram" && !fCumulative.empty()) {
+    fSpectrum = Spectrum::Histogram;
+  }
+  else {
+    if (name != "fixed") {
+      G4ExceptionDescription msg;
+      msg << "Spectrum " << name << " is not configured (energy list, min < max or "
+          << "histogram file missing), using the fixed /gun/energy.";
+      G4Exception("PrimaryGeneratorAction::SetSpectrum()", "B2Scan002", JustWarning, msg);
+    }
+    fSpectrum = Spectrum::Fixed;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// logUniform 已选中时再次检查范围：min >= max 时 log(max/min) <= 0，
+// 分箱号与抽样都无意义，回到固定能量（与 SetSpectrum 相同）
+void PrimaryGeneratorAction::SetEnergyRange(G4double minEnergy, G4double maxEnergy)
+{
+  fMinEnergy = minEnergy;
+  fMaxEnergy = maxEnergy;
+  if (fSpectrum == Spectrum::LogUniform && !HasLogRange()) {
+    G4ExceptionDescription msg;
+    msg << "logUniform spectrum needs 0 < min < max (min " << fMinEnergy / GeV
+        << " GeV, max " << fMaxEnergy / GeV << " GeV), using the fixed /gun/energy.";
+    G4Exception("PrimaryGeneratorAction::SetEnergyRange()", "B2Scan002", JustWarning, msg);
+    fSpectrum = Spectrum::Fixed;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 参数："<能量> ... <单位>"，例如 "20 40 80 100 GeV"
+void PrimaryGeneratorAction::SetEnergyList(G4String values)
+{
+  std::istringstream in(values);
+  std::vector<G4double> energies;
+  G4String token;
+  while (in >> token) {
+    std::istringstream number(token);
+    G4double value = 0.;
+    if (number >> value && number.eof()) {
+      energies.push_back(value);
+    }
+    else {
+      // 最后一个非数字为单位
+      for (auto& energy : energies) {
+        energy *= G4UIcommand::ValueOf(token.c_str());
+      }
+      break;
+    }
+  }
+  if (energies.empty() || *std::min_element(energies.begin(), energies.end()) <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "Invalid energy list \"" << values << "\", expected <energy> ... <unit>.";
+    G4Exception("PrimaryGeneratorAction::SetEnergyList()", "B2Scan002", JustWarning, msg);
+    return;
+  }
+  fEnergyList = energies;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 每行 "<下边界 GeV> <上边界 GeV> <权重>"，分箱须按能量递增且首尾相接
+void PrimaryGeneratorAction::LoadSpectrumFile(G4String fileName)
+{
+  G4bool hadHistogram = fSpectrum == Spectrum::Histogram;
+  // 读入失败时不能再按 histogram 抽样
+  fEdges.clear();
+  fCumulative.clear();
+  if (fSpectrum == Spectrum::Histogram) {
+    fSpectrum = Spectrum::Fixed;
+  }
+  if (fileName == "none") {
+    return;
+  }
+
+  std::ifstream in(fileName);
+  if (!in) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open energy spectrum " << fileName << ".";
+    G4Exception("PrimaryGeneratorAction::LoadSpectrumFile()", "B2Scan002", JustWarning, msg);
+    return;
+  }
+
+  std::string line;
+  G4double total = 0.;
+  G4bool ok = true;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    G4double low = 0., high = 0., weight = 0.;
+    if (!(fields >> low >> high >> weight)) {
+      continue;
+    }
+    if (fEdges.empty()) {
+      fEdges.push_back(low * GeV);
+    }
+    ok = ok && low > 0. && high > low && weight >= 0. && std::abs(low * GeV - fEdges.back()) < 1e-9 * GeV;
+    fEdges.push_back(high * GeV);
+    total += weight;
+    fCumulative.push_back(total);
+  }
+
+  if (!ok || total <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "Energy spectrum " << fileName << " needs contiguous increasing bins "
+        << "with a positive total weight, ignored.";
+    G4Exception("PrimaryGeneratorAction::LoadSpectrumFile()", "B2Scan002", JustWarning, msg);
+    fEdges.clear();
+    fCumulative.clear();
+    return;
+  }
+  for (auto& value : fCumulative) {
+    value /= total;
+  }
+  if (hadHistogram) {
+    fSpectrum = Spectrum::Histogram;
+  }
+  G4cout << "### Energy spectrum " << fileName << ": " << fCumulative.size() << " bins, "
+         << fEdges.front() / GeV << " - " << fEdges.back() / GeV << " GeV" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 参数："<能量> <单位> <事例数>"，例如 "20 GeV 1000"
+void PrimaryGeneratorAction::AddScanPoint(G4String values)
+{
+  std::istringstream in(values);
+  G4double value = 0.;
+  G4String unit;
+  G4int events = 0;
+  if (!(in >> value >> unit >> events) || value <= 0. || events <= 0) {
+    G4ExceptionDescription msg;
+    msg << "Invalid scan point \"" << values << "\", expected <energy> <unit> <events>.";
+    G4Exception("PrimaryGeneratorAction::AddScanPoint()", "B2Scan001", JustWarning, msg);
+    return;
+  }
+  fScanPoints.push_back({ value * G4UIcommand::ValueOf(unit.c_str()), events });
+
+  // 高能量（耗时长）的点排在前面，run 末尾只剩低能量事例
+  fScanOrder.resize(fScanPoints.size());
+  for (std::size_t k = 0; k < fScanOrder.size(); k++) {
+    fScanOrder[k] = G4int(k);
+  }
+  std::stable_sort(fScanOrder.begin(), fScanOrder.end(), [this](G4int a, G4int b) {
+    return fScanPoints[a].energy > fScanPoints[b].energy;
+  });
+  fScanEnd.clear();
+  G4int end = 0;
+  for (G4int point : fScanOrder) {
+    end += fScanPoints[point].events;
+    fScanEnd.push_back(end);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::ClearScan()
+{
+  fScanPoints.clear();
+  fScanOrder.clear();
+  fScanEnd.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 主线程：开启扫描、一次 beamOn 全部事例，再关闭扫描（这些命令都会广播给工作线程）
+void PrimaryGeneratorAction::ScanBeamOn()
+{
+  if (fScanEnd.empty()) {
+    G4Exception("PrimaryGeneratorAction::ScanBeamOn()", "B2Scan001", JustWarning,
+                "No scan points, use /B2/scan/add first.");
+    return;
+  }
+  auto uiManager = G4UImanager::GetUIpointer();
+  uiManager->ApplyCommand("/B2/scan/enable true");
+  uiManager->ApplyCommand("/run/beamOn " + std::to_string(fScanEnd.back()));
+  uiManager->ApplyCommand("/B2/scan/enable false");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/B2/scan/", "Multi-energy scan in one run");
+
+  auto& addCmd = fMessenger->DeclareMethod("add", &PrimaryGeneratorAction::AddScanPoint,
+    "Add a scan point: <energy> <unit> <events>, e.g. 20 GeV 1000.");
+  addCmd.SetParameterName("point", false);
+  addCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& clearCmd = fMessenger->DeclareMethod("clear", &PrimaryGeneratorAction::ClearScan,
+    "Remove all scan points.");
+  clearCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& enableCmd = fMessenger->DeclareProperty("enable", fScanEnabled,
+    "Take the beam energy of each event from the scan points (set by /B2/scan/beamOn; "
+    "with /run/beamOn the event count should be the sum of the scan points).");
+  enableCmd.SetParameterName("flag", false);
+  enableCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& beamOnCmd = fMessenger->DeclareMethod("beamOn", &PrimaryGeneratorAction::ScanBeamOn,
+    "Run all scan points as a single run (highest energy first).");
+  beamOnCmd.SetStates(G4State_Idle);
+  beamOnCmd.SetToBeBroadcasted(false);
+
+  fSpectrumMessenger = new G4GenericMessenger(this, "/B2/spectrum/", "Per-event beam energy spectrum");
+
+  auto& listCmd = fSpectrumMessenger->DeclareMethod("list", &PrimaryGeneratorAction::SetEnergyList,
+    "Energies for the list spectrum, cycled by event ID: <energy> ... <unit>, e.g. 20 40 80 GeV.");
+  listCmd.SetParameterName("energies", false);
+  listCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& minCmd = fSpectrumMessenger->DeclareMethodWithUnit("min", "GeV",
+    &PrimaryGeneratorAction::SetMinEnergy, "Lower energy of the logUniform spectrum.");
+  minCmd.SetParameterName("energy", false);
+  minCmd.SetRange("energy>0");
+  minCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& maxCmd = fSpectrumMessenger->DeclareMethodWithUnit("max", "GeV",
+    &PrimaryGeneratorAction::SetMaxEnergy, "Upper energy of the logUniform spectrum.");
+  maxCmd.SetParameterName("energy", false);
+  maxCmd.SetRange("energy>0");
+  maxCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& binsCmd = fSpectrumMessenger->DeclareProperty("logBins", fLogBins,
+    "Logarithmic energy bins of the reconstruction accumulators for the logUniform spectrum.");
+  binsCmd.SetParameterName("n", false);
+  binsCmd.SetRange("n>0");
+  binsCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& fileCmd = fSpectrumMessenger->DeclareMethod("file", &PrimaryGeneratorAction::LoadSpectrumFile,
+    "Histogram spectrum, one bin per line: <low GeV> <high GeV> <weight>; none to clear.");
+  fileCmd.SetParameterName("file", false);
+  fileCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  // 须在 list / min / max / file 之后设置
+  auto& typeCmd = fSpectrumMessenger->DeclareMethod("type", &PrimaryGeneratorAction::SetSpectrum,
+    "Beam energy per event: fixed (/gun/energy), list, logUniform or histogram "
+    "(set after the spectrum parameters).");
+  typeCmd.SetParameterName("type", false);
+  typeCmd.SetCandidates("fixed list logUniform histogram");
+  typeCmd.SetStates(G4State_PreInit, G4State_Idle);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
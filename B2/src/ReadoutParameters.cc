@@ -0,0 +1,215 @@
+/// \file B2/src/ReadoutParameters.cc
+/// \brief Implementation of the B2::ReadoutParameters class
+
+#include "ReadoutParameters.hh"
+#include "PhotonSampler.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ReadoutParameters::ReadoutParameters()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ReadoutParameters::~ReadoutParameters()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ReadoutParameters::SetSampling(G4String name)
+{
+  fSampling = (name == "event") ? Sampling::Event : Sampling::Step;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ReadoutParameters::SetCerenkovBeta(G4String name)
+{
+  fCerenkovAverageBeta = (name == "average");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 每行：<scint|cerenkov> <距离/mm> <透过率>，# 之后为注释；某种光纤没有点时仍用衰减长度
+void ReadoutParameters::LoadAttenuationFile(G4String fileName)
+{
+  for (auto& curve : fTransmissionCurve) {
+    curve.clear();
+  }
+  if (fileName == "none") {
+    return;
+  }
+
+  std::ifstream in(fileName);
+  if (!in) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open attenuation file " << fileName
+        << ", using the attenuation lengths.";
+    G4Exception("ReadoutParameters::LoadAttenuationFile()", "B2Readout001", JustWarning, msg);
+    return;
+  }
+
+  std::string line;
+  G4int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string fiber;
+    G4double distance = 0., transmission = 0.;
+    if (!(fields >> fiber)) {
+      continue;
+    }
+    if (!(fields >> distance >> transmission) || (fiber != "scint" && fiber != "cerenkov")
+        || distance < 0. || transmission < 0.) {
+      G4ExceptionDescription msg;
+      msg << fileName << ":" << lineNumber << ": expected <scint|cerenkov> <distance/mm> "
+          << "<transmission>, line ignored.";
+      G4Exception("ReadoutParameters::LoadAttenuationFile()", "B2Readout001", JustWarning, msg);
+      continue;
+    }
+    G4int type = G4int(fiber == "scint" ? FiberType::Scint : FiberType::Cerenkov);
+    fTransmissionCurve[type].push_back({ distance*mm, transmission });
+  }
+
+  for (auto& curve : fTransmissionCurve) {
+    std::sort(curve.begin(), curve.end(),
+              [](const TransmissionPoint& a, const TransmissionPoint& b) {
+                return a.distance < b.distance;
+              });
+  }
+  G4cout << "### Attenuation file " << fileName << ": "
+         << fTransmissionCurve[G4int(FiberType::Scint)].size() << " scint, "
+         << fTransmissionCurve[G4int(FiberType::Cerenkov)].size() << " cerenkov points" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ReadoutParameters::BenchmarkSampler(G4int nSamples)
+{
+  PhotonSampler::Benchmark(nSamples);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ReadoutParameters::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/B2/readout/", "Photon readout control");
+
+  auto& samplingCmd = fMessenger->DeclareMethod("sampling", &ReadoutParameters::SetSampling,
+    "Poisson sampling of photon counts: step (one draw per fiber step) or "
+    "event (sum the mean yield per channel, one draw per channel at end of event).");
+  samplingCmd.SetParameterName("mode", false);
+  samplingCmd.SetCandidates("step event");
+  samplingCmd.SetDefaultValue("step");
+  samplingCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& betaCmd = fMessenger->DeclareMethod("cerenkovBeta", &ReadoutParameters::SetCerenkovBeta,
+    "Kinetic energy used for the tabulated Cerenkov yield: post (end of step) "
+    "or average (mean of pre- and post-step point).");
+  betaCmd.SetParameterName("point", false);
+  betaCmd.SetCandidates("post average");
+  betaCmd.SetDefaultValue("post");
+  betaCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& scintCmd = fMessenger->DeclarePropertyWithUnit("scintAttenuation", "m",
+    fAttenuationLength[G4int(FiberType::Scint)],
+    "Attenuation length of the scintillating fibers (0 = no attenuation).");
+  scintCmd.SetParameterName("length", false);
+  scintCmd.SetRange("length>=0");
+  scintCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& cerenkovCmd = fMessenger->DeclarePropertyWithUnit("cerenkovAttenuation", "m",
+    fAttenuationLength[G4int(FiberType::Cerenkov)],
+    "Attenuation length of the quartz (Cerenkov) fibers (0 = no attenuation).");
+  cerenkovCmd.SetParameterName("length", false);
+  cerenkovCmd.SetRange("length>=0");
+  cerenkovCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& fileCmd = fMessenger->DeclareMethod("attenuationFile", &ReadoutParameters::LoadAttenuationFile,
+    "Measured transmission curves, one '<scint|cerenkov> <distance/mm> <transmission>' "
+    "per line; they replace the attenuation length of the fiber types they list. none clears.");
+  fileCmd.SetParameterName("file", false);
+  fileCmd.SetStates(G4State_PreInit, G4State_Idle);
+  fileCmd.SetToBeBroadcasted(false);
+
+  auto& mirrorCmd = fMessenger->DeclareProperty("mirror", fMirrorReflectivity,
+    "Reflectivity of a mirror on the front (upstream) fiber end; 0 = no mirror.");
+  mirrorCmd.SetParameterName("reflectivity", false);
+  mirrorCmd.SetRange("reflectivity>=0 && reflectivity<=1");
+  mirrorCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& scintIndexCmd = fMessenger->DeclareProperty("scintGroupIndex",
+    fGroupIndex[G4int(FiberType::Scint)],
+    "Group index of the scintillating fibers (propagation delay = distance*n/c).");
+  scintIndexCmd.SetParameterName("n", false);
+  scintIndexCmd.SetRange("n>=1");
+  scintIndexCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& cerenkovIndexCmd = fMessenger->DeclareProperty("cerenkovGroupIndex",
+    fGroupIndex[G4int(FiberType::Cerenkov)],
+    "Group index of the quartz (Cerenkov) fibers.");
+  cerenkovIndexCmd.SetParameterName("n", false);
+  cerenkovIndexCmd.SetRange("n>=1");
+  cerenkovIndexCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& binWidthCmd = fMessenger->DeclarePropertyWithUnit("timeBin", "ns", fTimeBinWidth,
+    "Width of the per-channel arrival-time bins.");
+  binWidthCmd.SetParameterName("width", false);
+  binWidthCmd.SetRange("width>0");
+  binWidthCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& binsCmd = fMessenger->DeclareProperty("timeBins", fTimeBins,
+    "Number of arrival-time bins per channel; the last one collects all later photons.");
+  binsCmd.SetParameterName("n", false);
+  binsCmd.SetRange("n>0");
+  binsCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& gateStartCmd = fMessenger->DeclarePropertyWithUnit("gateStart", "ns", fGateStart,
+    "Start of the integration gate (global arrival time, rounded to time bins).");
+  gateStartCmd.SetParameterName("time", false);
+  gateStartCmd.SetRange("time>=0");
+  gateStartCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& gateEndCmd = fMessenger->DeclarePropertyWithUnit("gateEnd", "ns", fGateEnd,
+    "End of the integration gate; 0 = no gate, all photons are counted.");
+  gateEndCmd.SetParameterName("time", false);
+  gateEndCmd.SetRange("time>=0");
+  gateEndCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& killCmd = fMessenger->DeclareProperty("killLate", fKillLate,
+    "Kill tracks whose global time exceeds the gate end (they cannot contribute).");
+  killCmd.SetParameterName("flag", false);
+  killCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& countCmd = fMessenger->DeclareProperty("countSteps", fCountSteps,
+    "Count all steps (benchmarks, adds a counter to every step); with the sd readout "
+    "it registers a stepping action and must be set before the first run.");
+  countCmd.SetParameterName("flag", false);
+  countCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& benchCmd = fMessenger->DeclareMethod("benchSampler", &ReadoutParameters::BenchmarkSampler,
+    "Micro-benchmark of the batch PhotonSampler against CLHEP::RandPoisson.");
+  benchCmd.SetParameterName("nSamples", true);
+  benchCmd.SetDefaultValue("1000000");
+  benchCmd.SetStates(G4State_PreInit, G4State_Idle);
+  benchCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -6,6 +6,12 @@
 #include "RunAction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "SteppingAction.hh"
+#include "FiberHitsCollection.hh"
+#include "AsyncWriter.hh"
+#include "Digitizer.hh"
+#include "WaveformSynthesizer.hh"
+#include "LoadBalancer.hh"
 // #include "Run.hh"
 
 #include "G4RunManager.hh"
@@ -16,6 +22,16 @@
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 
 namespace B2
 {
@@ -35,22 +51,159 @@ RunAction::RunAction() : G4UserRunAction()
   analysisManager->CreateNtuple("PhotonTree", "闪烁/切伦科夫光子数数据");
   analysisManager->CreateNtupleIColumn("ScintPhoton");  // 对应ScintPhoton/I
   analysisManager->CreateNtupleIColumn("CerenkovPhoton");  // 对应CerenkovPhoton/I
+
+  // 逐根铜棒读出（零压缩的向量列）
+  analysisManager->CreateNtupleIColumn("ScintChannel", fScintChannel);
+  analysisManager->CreateNtupleIColumn("ScintCount", fScintCount);
+  analysisManager->CreateNtupleIColumn("CerenkovChannel", fCerenkovChannel);
+  analysisManager->CreateNtupleIColumn("CerenkovCount", fCerenkovCount);
+
+  // 各 tower 的和（定长标量列）
+  fDetector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  G4int nTowers = fDetector->GetNumberOfTowers();
+  fScintTower.assign(nTowers, 0);
+  fCerenkovTower.assign(nTowers, 0);
+  for (G4int tower = 0; tower < nTowers; tower++) {
+    analysisManager->CreateNtupleIColumn("ScintTower" + std::to_string(tower));
+  }
+  for (G4int tower = 0; tower < nTowers; tower++) {
+    analysisManager->CreateNtupleIColumn("CerenkovTower" + std::to_string(tower));
+  }
+  // 数字化后的 ADC（零压缩的向量列）
+  analysisManager->CreateNtupleIColumn("ScintADCChannel", fScintADCChannel);
+  analysisManager->CreateNtupleIColumn("ScintADC", fScintADC);
+  analysisManager->CreateNtupleIColumn("CerenkovADCChannel", fCerenkovADCChannel);
+  analysisManager->CreateNtupleIColumn("CerenkovADC", fCerenkovADC);
+  // 波形特征量（向量列），原始波形按需写出
+  analysisManager->CreateNtupleIColumn("WaveChannel", fWaveChannel);
+  analysisManager->CreateNtupleDColumn("WaveAmplitude", fWaveAmplitude);
+  analysisManager->CreateNtupleDColumn("WaveIntegral", fWaveIntegral);
+  analysisManager->CreateNtupleDColumn("WavePeakTime", fWavePeakTime);
+  analysisManager->CreateNtupleDColumn("WaveTimeOverThreshold", fWaveTimeOverThreshold);
+  analysisManager->CreateNtupleFColumn("Waveform", fWaveform);
+  // 束流能量（GeV）与扫描点（未扫描时为 -1）
+  fEnergyColumn = analysisManager->CreateNtupleDColumn("BeamEnergy");
+  analysisManager->CreateNtupleIColumn("ScanPoint");
   analysisManager->FinishNtuple();  
+
+  // 直方图（范围在每个 run 开始时按束流能量重设）。只写激活的对象，
+  // 以便关闭逐事例输出时不写 ntuple
+  analysisManager->SetActivation(true);
+  analysisManager->CreateH1("S", "Scintillation signal;S [GeV]", fHistBins, 0., 1.);
+  analysisManager->CreateH1("C", "Cerenkov signal;C [GeV]", fHistBins, 0., 1.);
+  analysisManager->CreateH1("CoverS", "C/S;C/S", fHistBins, 0., 1.5);
+  analysisManager->CreateH1("Erec", "Dual-readout energy;E_{rec} [GeV]", fHistBins, 0., 1.);
+  analysisManager->CreateH1("ScintTime", "Scintillation arrival time;t [ns]", 64, 0., 256.);
+  analysisManager->CreateH1("CerenkovTime", "Cerenkov arrival time;t [ns]", 64, 0., 256.);
+  analysisManager->CreateH2("SvsC", "S vs C;S [GeV];C [GeV]",
+                            fHistBins, 0., 1., fHistBins, 0., 1.);
+  analysisManager->CreateH2("ResponseVsBeam", "Response vs beam energy;E_{beam} [GeV];E_{rec}/E_{beam}",
+                            fHistBins, 0., 1., fHistBins, 0., 1.5);
+
+  G4AccumulableManager::Instance()->RegisterAccumulable(fNSteps);
+  G4AccumulableManager::Instance()->RegisterAccumulable(fNFiberSteps);
+  G4AccumulableManager::Instance()->RegisterAccumulable(fOutputTime);
+  G4AccumulableManager::Instance()->RegisterAccumulable(fDigitizationTime);
+  G4AccumulableManager::Instance()->RegisterAccumulable(&fRecon);
+
+  DefineCommands();
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunAction::~RunAction()
+{
+  delete fMessenger;
+  delete fReconMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run*)
+void RunAction::AdoptPrimaryGenerator(std::unique_ptr<PrimaryGeneratorAction> generator)
+{
+  fMasterGenerator = std::move(generator);
+  fPrimaryGenerator = fMasterGenerator.get();
+}
+
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::BeginOfRunAction(const G4Run* run)
 {
   auto analysisManager = G4AnalysisManager::Instance();
+  BookHistograms();
+  analysisManager->SetNtupleActivation(fPerEvent && fFileType == FileType::Root);
   analysisManager->OpenFile(); 
 
+  if (fPerEvent && fFileType != FileType::Root) {
+    // 主线程启动写线程（工作线程的 run 在其之后开始）；串行模式下主线程同时也是生产者
+    if (IsMaster()) {
+      const DigitizerParameters& digiParameters = fDetector->GetDigitizerParameters();
+      if (digiParameters.IsEnabled() || digiParameters.IsWaveformEnabled()) {
+        G4ExceptionDescription msg;
+        msg << "raw/columnar records hold the photon counts only: the ADC values and waveform"
+            << " features of /B2/digi are not written. Use /B2/output/fileType root for them.";
+        G4Exception("RunAction::BeginOfRunAction()", "B2Output002", JustWarning, msg);
+      }
+      G4String fileName = analysisManager->GetFileName();
+      if (fileName.empty()) {
+        fileName = "PhotonData";
+      }
+      if (fFileType == FileType::Columnar) {
+        AsyncWriter::Instance().Start(std::make_unique<ColumnarSink>(), fileName + ".b2col",
+                                      fDetector->GetNumberOfTowers(), fQueueSize);
+      }
+      else {
+        AsyncWriter::Instance().Start(std::make_unique<RawSink>(), fileName + ".b2raw",
+                                      fDetector->GetNumberOfTowers(), fQueueSize);
+      }
+    }
+    if (!fQueue && (!IsMaster() || !G4Threading::IsMultithreadedApplication())) {
+      fQueue = AsyncWriter::Instance().AttachProducer();
+    }
+  }
+
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
 
+  // 每个能量分箱（扫描点或能谱分箱）一组重建累加量（各线程的设置相同）
+  fRecon.SetBins(fPrimaryGenerator ? fPrimaryGenerator->GetNumberOfEnergyBins() : 1);
+
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Reset();
 
+  if (IsMaster()) {
+    fTimer.Start();
+    // 未标定时 S、C 直方图以光子数计，E_rec 直方图不填，重建汇总中的能量不是 GeV
+    if (!IsCalibrated()) {
+      G4ExceptionDescription msg;
+      msg << "/B2/recon/scintCalib and /B2/recon/cerenkovCalib have not both been set:" << G4endl
+          << "the S, C and C/S histograms are booked and filled in photons, the E_rec and" << G4endl
+          << "E_rec/E_beam histograms are not written, and the energies of the reconstruction" << G4endl
+          << "summary are in uncalibrated units, not GeV. Set both constants from an electron run.";
+      G4Exception("RunAction::BeginOfRunAction()", "B2Recon001", JustWarning, msg);
+    }
+    // 积分门伸到最后一格：该格也收集门后的光子，在 ApplyGate 中被排除
+    const ReadoutParameters& readout = fDetector->GetReadoutParameters();
+    G4double lastBinStart = (readout.GetTimeBins() - 1) * readout.GetTimeBinWidth();
+    if (readout.HasGate() && readout.GetGateEnd() > lastBinStart) {
+      G4ExceptionDescription msg;
+      msg << "/B2/readout/gateEnd " << readout.GetGateEnd() / ns << " ns reaches the last time bin"
+          << " (from " << lastBinStart / ns << " ns), which also collects all later photons;" << G4endl
+          << "that bin is left out of the gate. Increase /B2/readout/timeBins or timeBin"
+          << " so that the gate ends at least one bin before the end of the window.";
+      G4Exception("RunAction::BeginOfRunAction()", "B2Readout002", JustWarning, msg);
+    }
+    // 负载均衡：按事例号的预计能量（GeV），工作线程的 run 在主线程之后开始
+    const PrimaryGeneratorAction* generator = fPrimaryGenerator;
+    LoadBalancer::Instance().BeginRun(run->GetNumberOfEventToBeProcessed(), [generator](G4int eventID) {
+      return generator ? generator->GetPlannedEnergy(eventID) / GeV : 1.;
+    });
+  }
+
+  if (fSteppingAction) fSteppingAction->BuildVolumeTable();
+  // killLate 的时间上限（几何所有线程共用，主线程在工作线程开始之前设定）
+  if (IsMaster()) fDetector->UpdateTimeLimit();
 
   // inform the runManager to save random number seed
   // G4RunManager::GetRunManager()->SetRandomNumberStore(false);
@@ -70,18 +223,471 @@ void RunAction::BeginOfRunAction(const G4Run*)
 void RunAction::EndOfRunAction(const G4Run* run)
 {
   // 关键：写入并关闭文件（与宏文件/analysis/file/close功能一致）
+  G4Timer outputTimer;
+  outputTimer.Start();
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   analysisManager->Write();
   analysisManager->CloseFile();
+  if (fPerEvent && fFileType != FileType::Root && IsMaster()) {
+    // 主线程的 EndOfRunAction 在所有工作线程结束之后：排空队列并关闭文件
+    AsyncWriter::Instance().Stop();
+  }
+
+  outputTimer.Stop();
 
   // fPhotonTree->Write();
   // fFile->Close();
 
+  G4AccumulableManager::Instance()->Merge();
+
+  if (!IsMaster()) {
+    LoadBalancer::Instance().WorkerFinished();
+    return;
+  }
+
+  fTimer.Stop();
+  G4int nofEvents = run->GetNumberOfEvent();
+  G4double wallTime = fTimer.GetRealElapsed();
+  G4double nSteps = fNSteps.GetValue();
+  G4cout << G4endl
+         << "--------------------End of Global Run-----------------------" << G4endl
+         << " Events: " << nofEvents
+         << "  wall time: " << wallTime << " s";
+  // 步数只在 /B2/readout/countSteps 时统计（stepping 读出）
+  if (nSteps > 0.) {
+    G4cout << "  steps: " << nSteps;
+    if (wallTime > 0.) {
+      G4cout << "  steps/s: " << nSteps / wallTime;
+    }
+    if (nofEvents > 0) {
+      G4cout << "  steps/event: " << nSteps / nofEvents;
+    }
+  }
+  G4cout << G4endl << " Output: " << fOutputTime.GetValue()
+         << " s in the event loop (summed over threads), "
+         << outputTimer.GetRealElapsed() << " s to write and close at end of run";
+  if (fDigitizationTime.GetValue() > 0.) {
+    G4cout << G4endl << " Digitization/waveforms: " << fDigitizationTime.GetValue()
+           << " s (summed over threads)";
+  }
+  if (G4Threading::IsMultithreadedApplication()) {
+    LoadBalancer::Instance().PrintStatistics();
+  }
+  if (nSteps > 0.) {
+    G4cout << G4endl << " Fiber steps: " << fNFiberSteps.GetValue()
+           << " (" << 100. * fNFiberSteps.GetValue() / nSteps << " %), the rest leave"
+           << " SteppingAction after the volume-table lookup";
+  }
+  G4cout << G4endl;
+
+  WriteReconSummary(run);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::FillPhotonTree(const G4Event* event, const FiberHitsCollection* scintHits,
+                               const FiberHitsCollection* cerenkovHits, const Digitizer* digitizer,
+                               const WaveformSynthesizer* waveforms)
+{
+  G4int scintTotal = scintHits ? scintHits->GetTotal() : 0;
+  G4int cerenkovTotal = cerenkovHits ? cerenkovHits->GetTotal() : 0;
+  G4double energy = 0.;
+  if (event->GetNumberOfPrimaryVertex() > 0) {
+    energy = event->GetPrimaryVertex()->GetPrimary()->GetKineticEnergy();
+  }
+  G4int eventID = event->GetEventID();
+  G4int scanPoint = fPrimaryGenerator ? fPrimaryGenerator->GetScanPoint(eventID) : -1;
+  G4int energyBin = fPrimaryGenerator ? fPrimaryGenerator->GetEnergyBin(eventID, energy) : 0;
+  AccumulateRecon(energyBin, scintTotal, cerenkovTotal, energy);
+  FillHistograms(scintTotal, cerenkovTotal, energy, scintHits, cerenkovHits);
+  if (!fPerEvent) {
+    return;
+  }
+
+  // 输出耗时（不含光子抽样），用于比较各输出格式
+  auto start = std::chrono::steady_clock::now();
+
+  // 向量列按引用绑定，填好向量即可
+  const ChannelMap& channelMap = fDetector->GetChannelMap();
+  FillChannels(scintHits, channelMap, fScintChannel, fScintCount, fScintTower);
+  FillChannels(cerenkovHits, channelMap, fCerenkovChannel, fCerenkovCount, fCerenkovTower);
+  FillADC(digitizer);
+  FillWaveforms(waveforms);
+
+  if (fFileType != FileType::Root) {
+    PushRecord(event->GetEventID(), scintTotal, cerenkovTotal, energy / MeV);
+  }
+  else {
+    G4AnalysisManager::Instance()->FillNtupleDColumn(fEnergyColumn, energy / GeV);
+    G4AnalysisManager::Instance()->FillNtupleIColumn(fEnergyColumn + 1, scanPoint);
+    FillNtupleRow(scintTotal, cerenkovTotal);
+  }
+
+  std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - start;
+  fOutputTime += elapsed.count();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void RunAction::FillADC(const Digitizer* digitizer)
+{
+  for (auto column : { &fScintADCChannel, &fScintADC, &fCerenkovADCChannel, &fCerenkovADC }) {
+    column->clear();
+  }
+  if (!digitizer) {
+    return;
+  }
+
+  // 数字化通道 = 类型*铜棒数 + 铜棒号，已按通道号排序
+  G4int nRods = digitizer->GetNumberOfRods();
+  for (G4int channel : digitizer->GetFiredChannels()) {
+    if (channel < nRods) {
+      fScintADCChannel.push_back(channel);
+      fScintADC.push_back(digitizer->GetADC(channel));
+    }
+    else {
+      fCerenkovADCChannel.push_back(channel - nRods);
+      fCerenkovADC.push_back(digitizer->GetADC(channel));
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::FillWaveforms(const WaveformSynthesizer* waveforms)
+{
+  if (!waveforms) {
+    fWaveChannel.clear();
+    fWaveAmplitude.clear();
+    fWaveIntegral.clear();
+    fWavePeakTime.clear();
+    fWaveTimeOverThreshold.clear();
+    fWaveform.clear();
+    return;
+  }
+  fWaveChannel = waveforms->GetChannels();
+  fWaveAmplitude = waveforms->GetAmplitudes();
+  fWaveIntegral = waveforms->GetIntegrals();
+  fWavePeakTime = waveforms->GetPeakTimes();
+  fWaveTimeOverThreshold = waveforms->GetTimesOverThreshold();
+  fWaveform.assign(waveforms->GetWaveforms().begin(), waveforms->GetWaveforms().end());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::FillNtupleRow(G4int scintTotal, G4int cerenkovTotal)
+{
+  auto man = G4AnalysisManager::Instance();
+  man->FillNtupleIColumn(0, scintTotal);
+  man->FillNtupleIColumn(1, cerenkovTotal);
 
+  G4int nTowers = G4int(fScintTower.size());
+  for (G4int tower = 0; tower < nTowers; tower++) {
+    man->FillNtupleIColumn(fTowerColumn + tower, fScintTower[tower]);
+    man->FillNtupleIColumn(fTowerColumn + nTowers + tower, fCerenkovTower[tower]);
+  }
+  man->AddNtupleRow();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::PushRecord(G4int eventID, G4int scintTotal, G4int cerenkovTotal,
+                           G4double energy)
+{
+  if (!fQueue || !AsyncWriter::Instance().IsActive()) {
+    return;
+  }
+
+  // 队列满时在 Claim() 中等待写线程（背压）
+  EventRecord* record = AsyncWriter::Claim(fQueue);
+  record->eventID = eventID;
+  record->scintTotal = scintTotal;
+  record->cerenkovTotal = cerenkovTotal;
+  record->energy = energy;
+  record->scintTower = fScintTower;
+  record->cerenkovTower = fCerenkovTower;
+  // 通道向量交换缓冲，不复制也不分配
+  record->scintChannel.swap(fScintChannel);
+  record->scintCount.swap(fScintCount);
+  record->cerenkovChannel.swap(fCerenkovChannel);
+  record->cerenkovCount.swap(fCerenkovCount);
+  fQueue->Publish();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::SetFileType(G4String name)
+{
+  if (name == "raw") {
+    fFileType = FileType::Raw;
+  }
+  else if (name == "columnar") {
+    fFileType = FileType::Columnar;
+  }
+  else {
+    fFileType = FileType::Root;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void RunAction::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/B2/output/", "Event output control");
+
+  auto& typeCmd = fMessenger->DeclareMethod("fileType", &RunAction::SetFileType,
+    "Event output: root (G4AnalysisManager ntuple, merged on the master), "
+    "raw (binary records written by a separate writer thread to <fileName>.b2raw) or "
+    "columnar (one file per column in <fileName>.b2col, same writer thread).");
+  typeCmd.SetParameterName("type", false);
+  typeCmd.SetCandidates("root raw columnar");
+  typeCmd.SetDefaultValue("root");
+  typeCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& queueCmd = fMessenger->DeclareProperty("queueSize", fQueueSize,
+    "Event records per worker queue for raw/columnar output (rounded up to a power "
+    "of two; existing queues are resized at the start of the next run).");
+  queueCmd.SetParameterName("n", false);
+  queueCmd.SetRange("n>0");
+  queueCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& perEventCmd = fMessenger->DeclareProperty("perEvent", fPerEvent,
+    "Write the per-event output (ntuple rows or raw/columnar records); "
+    "false keeps only the merged histograms and the reconstruction summary.");
+  perEventCmd.SetParameterName("flag", false);
+  perEventCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& binsCmd = fMessenger->DeclareProperty("histBins", fHistBins,
+    "Bins of the S, C, C/S and E_rec histograms (and per axis of S vs C).");
+  binsCmd.SetParameterName("n", false);
+  binsCmd.SetRange("n>0");
+  binsCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  fReconMessenger = new G4GenericMessenger(this, "/B2/recon/", "Dual-readout energy reconstruction");
+
+  auto& scintCmd = fReconMessenger->DeclareMethod("scintCalib", &RunAction::SetScintCalib,
+    "Scintillation photons per GeV (electron calibration).");
+  scintCmd.SetParameterName("photonsPerGeV", false);
+  scintCmd.SetRange("photonsPerGeV>0");
+  scintCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& cerenkovCmd = fReconMessenger->DeclareMethod("cerenkovCalib", &RunAction::SetCerenkovCalib,
+    "Cerenkov photons per GeV (electron calibration).");
+  cerenkovCmd.SetParameterName("photonsPerGeV", false);
+  cerenkovCmd.SetRange("photonsPerGeV>0");
+  cerenkovCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& chiCmd = fReconMessenger->DeclareProperty("chi", fChi,
+    "Dual-readout chi: E = (S - chi*C)/(1 - chi) with calibrated S and C.");
+  chiCmd.SetParameterName("chi", false);
+  chiCmd.SetRange("chi>=0 && chi<1");
+  chiCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& summaryCmd = fReconMessenger->DeclareProperty("summaryFile", fSummaryFile,
+    "Text file to which the master appends one line of reconstruction results per run.");
+  summaryCmd.SetParameterName("file", false);
+  summaryCmd.SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::SetScintCalib(G4double photonsPerGeV)
+{
+  fScintCalib = photonsPerGeV;
+  fScintCalibrated = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::SetCerenkovCalib(G4double photonsPerGeV)
+{
+  fCerenkovCalib = photonsPerGeV;
+  fCerenkovCalibrated = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::AccumulateRecon(G4int bin, G4int scintTotal, G4int cerenkovTotal,
+                                G4double beamEnergy)
+{
+  G4double s = scintTotal;
+  G4double c = cerenkovTotal;
+  G4double e = (s / fScintCalib - fChi * c / fCerenkovCalib) / (1. - fChi);
+  G4double beam = beamEnergy / GeV;
+  fRecon.Fill(bin, s, c, e, beam, beam > 0. ? e / beam : 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::BookHistograms()
+{
+  G4double beam = 20.;
+  if (fPrimaryGenerator && fPrimaryGenerator->GetMaxEnergy() > 0.) {
+    beam = fPrimaryGenerator->GetMaxEnergy() / GeV;
+  }
+
+  // 刻度后的 S、C 与重建能量取到束流能量的 1.5 倍；未标定时 S、C 以光子数计，
+  // 范围按名义光产额放大（result/ 中的基准数据约 7e4 闪烁、650 切伦科夫光子/GeV）
+  G4bool calibrated = IsCalibrated();
+  G4double scintPerGeV = calibrated ? 1. : kNominalScintPerGeV;
+  G4double cerenkovPerGeV = calibrated ? 1. : kNominalCerenkovPerGeV;
+  G4double range = 1.5 * beam;
+  auto man = G4AnalysisManager::Instance();
+  man->SetH1(0, fHistBins, 0., range * scintPerGeV);
+  man->SetH1(1, fHistBins, 0., range * cerenkovPerGeV);
+  man->SetH1(2, fHistBins, 0., 1.5 * cerenkovPerGeV / scintPerGeV);
+  man->SetH1(3, fHistBins, 0., range);
+  man->SetH2(0, fHistBins, 0., range * scintPerGeV, fHistBins, 0., range * cerenkovPerGeV);
+  man->SetH2(1, fHistBins, 0., 1.1 * beam, fHistBins, 0., 1.5);
+  G4String unit = calibrated ? " [GeV]" : " [photons]";
+  man->SetH1XAxisTitle(0, "S" + unit);
+  man->SetH1XAxisTitle(1, "C" + unit);
+  man->SetH2XAxisTitle(0, "S" + unit);
+  man->SetH2YAxisTitle(0, "C" + unit);
+  // 未标定的 E_rec 混合两种光子数，没有意义：不写
+  man->SetH1Activation(3, calibrated);
+  man->SetH2Activation(1, calibrated);
+
+  // 到达时间分布与读出的时间分格一致
+  const ReadoutParameters& parameters = fDetector->GetReadoutParameters();
+  G4int nTimeBins = parameters.GetTimeBins();
+  G4double window = nTimeBins * parameters.GetTimeBinWidth() / ns;
+  man->SetH1(4, nTimeBins, 0., window);
+  man->SetH1(5, nTimeBins, 0., window);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::FillHistograms(G4int scintTotal, G4int cerenkovTotal, G4double beamEnergy,
+                               const FiberHitsCollection* scintHits,
+                               const FiberHitsCollection* cerenkovHits)
+{
+  // 未标定时两个刻度常数取 1，S、C 即光子数
+  G4bool calibrated = IsCalibrated();
+  G4double s = calibrated ? scintTotal / fScintCalib : scintTotal;
+  G4double c = calibrated ? cerenkovTotal / fCerenkovCalib : cerenkovTotal;
+
+  auto man = G4AnalysisManager::Instance();
+  man->FillH1(0, s);
+  man->FillH1(1, c);
+  if (s > 0.) {
+    man->FillH1(2, c / s);
+  }
+  man->FillH2(0, s, c);
+  if (calibrated) {
+    G4double e = (s - fChi * c) / (1. - fChi);
+    man->FillH1(3, e);
+    if (beamEnergy > 0.) {
+      man->FillH2(1, beamEnergy / GeV, e / (beamEnergy / GeV));
+    }
+  }
+
+  // 到达时间分布（不受积分门影响），每个时间格按光子数加权
+  G4int id = 4;
+  for (auto hits : { scintHits, cerenkovHits }) {
+    if (hits) {
+      const auto& profile = hits->GetTimeProfile();
+      G4double width = hits->GetTimeBinWidth() / ns;
+      for (std::size_t bin = 0; bin < profile.size(); bin++) {
+        if (profile[bin] > 0) {
+          man->FillH1(id, (bin + 0.5) * width, profile[bin]);
+        }
+      }
+    }
+    id++;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 主线程：由合并后的累加量计算均值、RMS、分辨率与线性，打印并追加到汇总文件
+// （每个扫描点一行）
+void RunAction::WriteReconSummary(const G4Run* run)
+{
+  if (run->GetNumberOfEvent() <= 0) {
+    return;
+  }
+
+  std::ofstream out(fSummaryFile, std::ios::app);
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fSummaryFile << ", reconstruction summary not written.";
+    G4Exception("RunAction::WriteReconSummary()", "B2Recon002", JustWarning, msg);
+  }
+  else if (out.tellp() == 0) {
+    out << "# run file events beam_GeV S_mean S_rms C_mean C_rms SC_corr"
+           " E_mean_GeV E_rms_GeV resolution linearity chi scintCalib cerenkovCalib\n";
+  }
+  G4String fileName = G4AnalysisManager::Instance()->GetFileName();
+
+  G4cout << " Recon (chi " << fChi << ", S " << fScintCalib << " /GeV, C "
+         << fCerenkovCalib << " /GeV):" << G4endl;
+  for (G4int bin = 0; bin < fRecon.GetBins(); bin++) {
+    G4double n = fRecon.GetN(bin);
+    if (n <= 0.) {
+      continue;
+    }
+    auto rms = [n](G4double sum, G4double sum2) {
+      return std::sqrt(std::max(0., sum2 / n - (sum / n) * (sum / n)));
+    };
+    G4double meanS = fRecon.GetSumS(bin) / n;
+    G4double meanC = fRecon.GetSumC(bin) / n;
+    G4double rmsS = rms(fRecon.GetSumS(bin), fRecon.GetSumS2(bin));
+    G4double rmsC = rms(fRecon.GetSumC(bin), fRecon.GetSumC2(bin));
+    G4double covSC = fRecon.GetSumSC(bin) / n - meanS * meanC;
+    G4double corrSC = (rmsS > 0. && rmsC > 0.) ? covSC / (rmsS * rmsC) : 0.;
+    G4double meanE = fRecon.GetSumE(bin) / n;
+    G4double rmsE = rms(fRecon.GetSumE(bin), fRecon.GetSumE2(bin));
+    G4double beam = fRecon.GetSumBeam(bin) / n;
+    // 分辨率与线性取自逐事例的 E/E束流，能谱分箱内能量不同也适用
+    G4double linearity = fRecon.GetSumR(bin) / n;
+    G4double rmsR = rms(fRecon.GetSumR(bin), fRecon.GetSumR2(bin));
+    G4double resolution = linearity > 0. ? rmsR / linearity : 0.;
+
+    G4cout << "   beam " << beam << " GeV (" << n << " events)" << G4endl
+           << "   S " << meanS << " +- " << rmsS << "  C " << meanC << " +- " << rmsC
+           << "  corr(S,C) " << corrSC << G4endl
+           << "   E " << meanE << " +- " << rmsE << " GeV  resolution " << resolution
+           << "  linearity " << linearity << G4endl;
+
+    if (out) {
+      out << run->GetRunID() << " " << (fileName.empty() ? "-" : fileName) << " " << n
+          << " " << beam << " " << meanS << " " << rmsS << " " << meanC << " " << rmsC
+          << " " << corrSC << " " << meanE << " " << rmsE << " " << resolution
+          << " " << linearity << " " << fChi << " " << fScintCalib << " " << fCerenkovCalib << "\n";
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::FillChannels(const FiberHitsCollection* hits, const ChannelMap& channelMap,
+                             std::vector<G4int>& channels, std::vector<G4int>& counts,
+                             std::vector<G4int>& towerSums)
+{
+  channels.clear();
+  counts.clear();
+  std::fill(towerSums.begin(), towerSums.end(), 0);
+  if (!hits) {
+    return;
+  }
+
+  // 被击中通道按编号排序后写出（抽样后光子数为0的通道不写）
+  channels = hits->GetFiredChannels();
+  std::sort(channels.begin(), channels.end());
+  std::size_t nKept = 0;
+  for (G4int channel : channels) {
+    G4int nPhotons = hits->GetPhotons(channel);
+    if (nPhotons <= 0) {
+      continue;
+    }
+    channels[nKept++] = channel;
+    counts.push_back(nPhotons);
+    towerSums[channelMap.GetTower(channel)] += nPhotons;
+  }
+  channels.resize(nKept);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 }
\ No newline at end of file
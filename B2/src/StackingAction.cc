@@ -0,0 +1,34 @@
+/// \file B2/src/StackingAction.cc
+/// \brief Implementation of the B2::StackingAction class
+
+// StackingAction.cc：积分门之后产生的径迹直接杀掉
+#include "StackingAction.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4RunManager.hh"
+#include "G4Track.hh"
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingAction::PrepareNewEvent()
+{
+  if (!fDetector) {
+    fDetector = static_cast<const DetectorConstruction*>(
+      G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  }
+  fKillTime = fDetector->GetReadoutParameters().GetKillTime();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  return track->GetGlobalTime() > fKillTime ? fKill : fUrgent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -10,12 +10,11 @@
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
 
-#include "G4ParticleDefinition.hh"
-#include "G4Track.hh"
-#include "CLHEP/Random/RandPoisson.h" // 泊松统计头文件
 
-#include "CLHEP/Units/SystemOfUnits.h" // 单位头文件CLHEP
+#include <algorithm>
+
 namespace B2
 {
 
@@ -26,82 +25,70 @@ SteppingAction::SteppingAction(EventAction* eventAction)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-void SteppingAction::UserSteppingAction(const G4Step* step)
+
+// 建立 逻辑体instance ID -> 体积类型 的平铺表（每个线程一份，每个run开始时重建）
+void SteppingAction::BuildVolumeTable()
 {
-  // 1. 获取得分体积（闪烁光纤+切伦科夫光纤）
-  auto detConst = (DetectorConstruction*)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
-  G4LogicalVolume* scintVol = detConst->GetScoringVolume();
-  G4LogicalVolume* cerenkovVol = detConst->GetScoringVolumeCerenkov();
-
-  // 2. 获取当前步长的核心信息
-  G4LogicalVolume* currentVol = step->GetPreStepPoint()->GetTouchable()->GetVolume()->GetLogicalVolume();
-  G4double edep = step->GetTotalEnergyDeposit(); // 沉积能量（闪烁光子计算用）
-  G4Track* track = step->GetTrack(); // 粒子轨迹（切伦科夫光子计算用）
-  G4double stepLength = step->GetStepLength(); // 步长长度（切伦科夫光子计算用）
-
-  // ====================== 闪烁光子数计算 ======================
-//   if (currentVol == scintVol) {
-//     fEventAction->AddEdep(edep); // 无论能量多小都记录
-
-//     if (edep > 0) {
-//         G4double meanPhotons = edep * fScintillationYield * fCollectionEfficiency;
-//         G4int nPhotons = CLHEP::RandPoisson::shoot(meanPhotons);
-//         if (nPhotons > 0) {
-//             fEventAction->AddScintPhotons(nPhotons);
-//         }
-//     }
-//  }
-  if (currentVol == scintVol && edep > 0) // 仅在闪烁光纤内且有能量沉积时计算
-  {
-    // 步骤1：计算平均光子数
-    G4double meanPhotons = edep * fScintillationYield * fCollectionEfficiency;
-    // G4cout << "平均光子数meanPhotons：" << meanPhotons << G4endl; 
-    // G4cout << "当前能量沉积edep（默认MeV）：" << edep << G4endl;
-    // G4cout << "闪烁产额fScintillationYield：" << fScintillationYield << G4endl;
-    // G4cout << "收集效率fCollectionEfficiency：" << fCollectionEfficiency << G4endl;
-
-    // 步骤2：泊松抽样得到实际光子数
-    G4int nPhotons = CLHEP::RandPoisson::shoot(meanPhotons);
-
-    // 步骤3：传递给EventAction累加
-    if (nPhotons > 0) {
-      fEventAction->AddScintPhotons(nPhotons);
-    }
+  fDetector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  auto lvStore = G4LogicalVolumeStore::GetInstance();
+
+  G4int maxID = 0;
+  for (auto lv : *lvStore) {
+    maxID = std::max(maxID, lv->GetInstanceID());
   }
+  fVolumeKind.assign(maxID + 1, kPassive);
 
-  // ====================== 切伦科夫光子数计算 ======================
-  if (currentVol == cerenkovVol) // 仅在切伦科夫光纤内计算
-  {
-    // 步骤1：判断粒子是否为带电粒子（切伦科夫效应仅对带电粒子有效）
-    const G4ParticleDefinition* particle = track->GetParticleDefinition();
-    if (!particle->GetPDGCharge()) { // 中性粒子：直接返回0
-      return;
-    }
+  // 切伦科夫产额表与光传输表按本 run 的读出参数重建
+  fResponse.BeginOfRun(fDetector->GetReadoutParameters(), fDetector->GetFiberLength());
+
+  fCountSteps = fDetector->GetReadoutParameters().GetCountSteps();
 
-    // 步骤2：计算粒子的β值（v/c，速度与光速的比值）
-    G4ThreeVector momentum = track->GetMomentum(); // 获取粒子动量（矢量，含大小和方向）
-    G4double momentumMag = momentum.mag(); // 获取动量的大小
-    G4double totalEnergy = track->GetTotalEnergy(); // 获取粒子相对论总能量
-    G4double beta = momentumMag / totalEnergy; // 计算β值
+  // sd 读出时光纤由 FiberSD 处理，步进动作只统计步数
+  if (fDetector->GetReadout() == DetectorConstruction::Readout::SD) {
+    return;
+  }
 
-    if (beta <= fBetaThreshold) { // 低于阈值：不产生光子
-      return;
+  for (auto lv : *lvStore) {
+    if (lv == fDetector->GetScoringVolume()) {
+      fVolumeKind[lv->GetInstanceID()] = kScint;
+    }
+    else if (lv == fDetector->GetScoringVolumeCerenkov()) {
+      fVolumeKind[lv->GetInstanceID()] = kCerenkov;
     }
+  }
+}
 
-    // 步骤3：计算单位长度光子数（每厘米）
-    G4double dNdL = 369.0 * (1.0 - 1.0/(beta*beta*fRefIndex*fRefIndex));
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+void SteppingAction::UserSteppingAction(const G4Step* step)
+{
+  if (fCountSteps) fEventAction->CountStep();
 
-    // 步骤4：计算平均光子数（考虑步长长度和收集效率）
-    G4double meanPhotons = dNdL * (stepLength / CLHEP::cm) * fCollectionEfficiency;
-    // G4cout << "平均切伦科夫光子数meanPhotons：" << meanPhotons << G4endl; 
+  // 1. 按逻辑体 instance ID 查分类表，非光纤的步（绝大多数）在这里直接返回
+  G4LogicalVolume* currentVol = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+  G4int kind = fVolumeKind[currentVol->GetInstanceID()];
+  if (kind == kPassive) {
+    return;
+  }
+  if (fCountSteps) fEventAction->CountFiberStep();
+
+  // 2. 平均光子数（与 FiberSD 共用 FiberResponse）
+  FiberType type = (kind == kScint) ? FiberType::Scint : FiberType::Cerenkov;
+  G4double arrivalTime = 0.;
+  G4double meanPhotons = fResponse.MeanPhotons(type, step, arrivalTime);
+  if (meanPhotons <= 0.) {
+    return;
+  }
 
-    // 步骤5：泊松抽样得到实际光子数
-    G4int nPhotons = CLHEP::RandPoisson::shoot(meanPhotons);
+  // 3. 按铜棒通道传递给EventAction累加
+  G4int channel = fDetector->GetChannelMap().GetRodID(step->GetPreStepPoint()->GetTouchable());
 
-    // 步骤6：传递给EventAction累加
-    if (nPhotons > 0) {
-      fEventAction->AddCerenkovPhotons(nPhotons);
-    }
+  // 泊松抽样在事例结束时批量进行；延迟抽样时每个通道只抽一次
+  if (fDetector->GetReadoutParameters().GetSampling() == ReadoutParameters::Sampling::Event) {
+    fEventAction->AddMeanPhotons(type, channel, meanPhotons, arrivalTime);
+  }
+  else {
+    fEventAction->AddStepPhotons(type, channel, meanPhotons, arrivalTime);
   }
 }
 
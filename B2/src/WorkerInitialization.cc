@@ -0,0 +1,170 @@
+/// \file B2/src/WorkerInitialization.cc
+/// \brief Implementation of the B2::WorkerInitialization class
+
+// WorkerInitialization.cc：工作线程启动时按策略绑定 CPU（命令行 -a）
+#include "WorkerInitialization.hh"
+
+#include "G4Threading.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace B2
+{
+
+namespace
+{
+  // 解析 "0-15,32-47" 形式的 CPU 列表
+  std::vector<G4int> ParseCpuList(const std::string& text)
+  {
+    std::vector<G4int> cpus;
+    std::istringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+      std::size_t dash = range.find('-');
+      try {
+        G4int first = std::stoi(range.substr(0, dash));
+        G4int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (G4int cpu = first; cpu <= last; cpu++) {
+          cpus.push_back(cpu);
+        }
+      }
+      catch (const std::exception&) {
+        // 空行或格式不对的部分跳过
+      }
+    }
+    return cpus;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WorkerInitialization::WorkerInitialization(Affinity affinity)
+: fAffinity(affinity)
+{
+  if (fAffinity != Affinity::None) {
+    ReadTopology();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WorkerInitialization::ParseAffinity(const G4String& name, Affinity& affinity)
+{
+  if (name == "none") affinity = Affinity::None;
+  else if (name == "compact") affinity = Affinity::Compact;
+  else if (name == "scatter") affinity = Affinity::Scatter;
+  else if (name == "numa") affinity = Affinity::Numa;
+  else return false;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WorkerInitialization::ReadTopology()
+{
+#ifdef __linux__
+  // 只用进程亲和性掩码中允许的 CPU（taskset / 批处理系统的限制）
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+
+  for (G4int node = 0;; node++) {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!in) {
+      break;
+    }
+    std::string text;
+    std::getline(in, text);
+    std::vector<G4int> cpus;
+    for (G4int cpu : ParseCpuList(text)) {
+      if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      fNodes.push_back(cpus);
+    }
+  }
+
+  // 没有 NUMA 信息时当作一个节点
+  if (fNodes.empty()) {
+    std::vector<G4int> cpus;
+    for (G4int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) {
+        cpus.push_back(cpu);
+      }
+    }
+    fNodes.push_back(cpus);
+  }
+
+  G4cout << "### CPU affinity: " << fNodes.size() << " NUMA node(s):";
+  for (const auto& cpus : fNodes) {
+    G4cout << " " << cpus.size();
+  }
+  G4cout << " CPUs" << G4endl;
+#else
+  G4Exception("WorkerInitialization::ReadTopology()", "B2Thread001", JustWarning,
+              "CPU pinning is only implemented on Linux, workers are not pinned.");
+  fAffinity = Affinity::None;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WorkerInitialization::WorkerStart() const
+{
+#ifdef __linux__
+  if (fAffinity == Affinity::None || fNodes.empty() || fNodes.front().empty()) {
+    return;
+  }
+
+  G4int worker = std::max(G4Threading::G4GetThreadId(), 0);
+  G4int nNodes = G4int(fNodes.size());
+  std::vector<G4int> cpus;
+  if (fAffinity == Affinity::Numa) {
+    cpus = fNodes[worker % nNodes];
+  }
+  else {
+    // compact：按节点依次排列的 CPU；scatter：各节点轮流取一个 CPU
+    std::vector<G4int> order;
+    for (const auto& node : fNodes) {
+      order.insert(order.end(), node.begin(), node.end());
+    }
+    if (fAffinity == Affinity::Scatter) {
+      std::size_t nCpus = order.size();
+      order.clear();
+      for (std::size_t k = 0; order.size() < nCpus; k++) {
+        for (const auto& node : fNodes) {
+          if (k < node.size()) {
+            order.push_back(node[k]);
+          }
+        }
+      }
+    }
+    cpus.push_back(order[worker % order.size()]);
+  }
+
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (G4int cpu : cpus) {
+    CPU_SET(cpu, &mask);
+  }
+  // pid 0 即调用线程
+  if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+    G4ExceptionDescription msg;
+    msg << "Cannot pin worker " << worker << " to CPU " << cpus.front() << ".";
+    G4Exception("WorkerInitialization::WorkerStart()", "B2Thread001", JustWarning, msg);
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}